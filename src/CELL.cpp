@@ -1,156 +1,817 @@
 #include "framework.h"
 #include "CELL.h"
+#include "FixedTimeSlice.h"
 #include "Utilities.h"
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif // !_WIN32
 using namespace std;
 using namespace RYANS_UTILITIES;
 // Add this cpp file
 
-ALL_CELL_POSITIONS::ALL_CELL_POSITIONS() {
-	for (auto i = 0; i < layoutWidth; ++i) {
-		for (auto j = 0; j < layoutHeight; ++j) {
-			positions.emplace_back(i, j);
+NEIGHBOR_POSITIONS::NEIGHBOR_POSITIONS(CELL_POSITION position, BOARD_SIZE size) noexcept {
+	auto iMin = position.row == 0 ? 0 : -1;
+	auto iMax = position.row + 1 >= size.height ? 0 : 1;
+	auto jMin = position.column == 0 ? 0 : -1;
+	auto jMax = position.column + 1 >= size.width ? 0 : 1;
+
+	for (auto i = iMin; i <= iMax; ++i) {
+		for (auto j = jMin; j <= jMax; ++j) {
+			if (i == 0 && j == 0) { continue; }
+			positions[count++] = CELL_POSITION{ position.row + i, position.column + j };
+		}
+	}
+}
+
+// Tiles for the sweep kernels, which are the units of parallel work
+// Single generation tiles span whole rows and keep their rolling window of rows hot in cache
+// Multi-generation tiles are small enough that a tile & its halo stay in cache for every generation
+static constexpr auto rowsPerTile = 16u;
+static constexpr auto temporalTileRows = 64u;
+static constexpr auto temporalTileColumns = 256u;
+static_assert(rowsPerTile % POPULATION_PYRAMID::leafSide == 0 && temporalTileRows % POPULATION_PYRAMID::leafSide == 0 && temporalTileColumns % POPULATION_PYRAMID::leafSide == 0,
+	"Tiles must cover whole leaf blocks, so that each tile can count its own.");
+
+static std::vector<CELL_REGION> TileBoard(BOARD_SIZE size, unsigned int tileRows, unsigned int tileColumns) {
+	auto tiles = std::vector<CELL_REGION>{ };
+	for (auto row = 0u; row < size.height; row += tileRows) {
+		for (auto column = 0u; column < size.width; column += tileColumns) {
+			auto end = CELL_POSITION{ std::min(row + tileRows, size.height), std::min(column + tileColumns, size.width) };
+			tiles.push_back(CELL_REGION{ CELL_POSITION{ row, column }, end });
 		}
 	}
+	return tiles;
+}
+
+TIME_SLICE::TIME_SLICE(BOARD_SIZE size) : TIME_SLICE(size, MEMORY_PLACEMENT{ }) { }
+
+TIME_SLICE::TIME_SLICE(BOARD_SIZE size, MEMORY_PLACEMENT placement)
+	: m_Size{ size },
+	m_Stride{ static_cast<std::ptrdiff_t>(size.width) + 2 },
+	m_NeighborOffsets{ -m_Stride - 1, -m_Stride, -m_Stride + 1, -1, 1, m_Stride - 1, m_Stride, m_Stride + 1 },
+	m_Layout(static_cast<size_t>(m_Stride) * (static_cast<size_t>(size.height) + 2), FRAME_ALLOCATOR<CELL>{ placement }),
+	m_Pyramid{ size } { }
+
+void* MapFrameMemory(size_t bytes, [[maybe_unused]] bool hugePages) {
+#ifdef _WIN32
+	auto* memory = VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+	if (!memory) { throw std::bad_alloc{ }; }
+	return memory;
+#else
+	auto* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (memory == MAP_FAILED) { throw std::bad_alloc{ }; }
+#ifdef MADV_HUGEPAGE
+	if (hugePages) { madvise(memory, bytes, MADV_HUGEPAGE); }
+#endif // MADV_HUGEPAGE
+	return memory;
+#endif // _WIN32
+}
+
+void UnmapFrameMemory(void* memory, size_t bytes) noexcept {
+#ifdef _WIN32
+	VirtualFree(memory, 0, MEM_RELEASE);
+#else
+	munmap(memory, bytes);
+#endif // _WIN32
+}
+
+POPULATION_PYRAMID::POPULATION_PYRAMID(BOARD_SIZE size) {
+	auto blocks = BOARD_SIZE{ std::max((size.width + leafSide - 1) >> leafShift, 1u), std::max((size.height + leafSide - 1) >> leafShift, 1u) };
+	m_LevelSizes.push_back(blocks);
+	m_Leaves.resize(blocks.CellCount());
+	while (blocks.width > 1 || blocks.height > 1) {
+		blocks = BOARD_SIZE{ (blocks.width + 1) / 2, (blocks.height + 1) / 2 };
+		m_LevelSizes.push_back(blocks);
+		m_Upper.emplace_back(blocks.CellCount());
+	}
 }
 
-ADJACENCY_LIST::ADJACENCY_LIST() {
-	for (auto& position : allPositions) {
-		auto iMin = position.row == 0 ? 0 : -1;
-		auto iMax = position.row == layoutWidth - 1 ? 0 : 1;
+[[nodiscard]] std::uint64_t POPULATION_PYRAMID::Count(size_t level, CELL_POSITION block) const noexcept {
+	auto index = static_cast<size_t>(block.row) * m_LevelSizes[level].width + block.column;
+	return level == 0 ? m_Leaves[index] : m_Upper[level - 1][index];
+}
 
-		for (auto i = iMin; i <= iMax; ++i) {
-			auto jMin = position.column == 0 ? 0 : -1;
-			auto jMax = position.column == layoutHeight - 1 ? 0 : 1;
+// An edit changes one leaf & each block above it
+void POPULATION_PYRAMID::Add(CELL_POSITION cell, int delta) noexcept {
+	auto block = CELL_POSITION{ cell.row >> leafShift, cell.column >> leafShift };
+	auto& leaf = m_Leaves[static_cast<size_t>(block.row) * m_LevelSizes[0].width + block.column];
+	leaf = static_cast<std::uint16_t>(leaf + delta);
+	for (auto level = size_t{ 1 }; level < Levels(); ++level) {
+		block = CELL_POSITION{ block.row / 2, block.column / 2 };
+		m_Upper[level - 1][static_cast<size_t>(block.row) * m_LevelSizes[level].width + block.column] += static_cast<std::uint64_t>(static_cast<std::int64_t>(delta));
+	}
+}
+
+// Summing a level costs a quarter of the level below, so all levels above the leaves cost a third of the leaf count
+void POPULATION_PYRAMID::SumUpperLevels() noexcept {
+	for (auto level = size_t{ 1 }; level < Levels(); ++level) {
+		auto below = m_LevelSizes[level - 1];
+		auto child = [&](unsigned int row, unsigned int column) { return row < below.height && column < below.width ? Count(level - 1, CELL_POSITION{ row, column }) : 0; };
+		auto& counts = m_Upper[level - 1];
+		for (auto block : ALL_CELL_POSITIONS{ m_LevelSizes[level] }) {
+			auto row = block.row * 2;
+			auto column = block.column * 2;
+			counts[static_cast<size_t>(block.row) * m_LevelSizes[level].width + block.column] = child(row, column) + child(row, column + 1) + child(row + 1, column) + child(row + 1, column + 1);
+		}
+	}
+}
 
-			for (auto j = jMin; j <= jMax; ++j) {
-				if (i == 0 && j == 0) { continue; }
-				adjacencyList[position.row][position.column].emplace_back(position.row + i, position.column + j);
+// Rows are walked in memory order, each adding its run of cells to every leaf block it crosses
+void TIME_SLICE::CountLeafBlocks(CELL_REGION region) noexcept {
+	constexpr auto alive = static_cast<std::uint8_t>(LIFE_STATE::ALIVE);
+	const auto leafColumns = m_Pyramid.m_LevelSizes[0].width;
+	const auto firstBlockColumn = region.first.column >> POPULATION_PYRAMID::leafShift;
+	const auto endBlockColumn = (region.end.column + POPULATION_PYRAMID::leafSide - 1) >> POPULATION_PYRAMID::leafShift;
+	for (auto blockRow = region.first.row >> POPULATION_PYRAMID::leafShift; (blockRow << POPULATION_PYRAMID::leafShift) < region.end.row; ++blockRow) {
+		auto* leaves = &m_Pyramid.m_Leaves[static_cast<size_t>(blockRow) * leafColumns];
+		std::fill(leaves + firstBlockColumn, leaves + endBlockColumn, std::uint16_t{ 0 });
+
+		const auto firstRow = blockRow << POPULATION_PYRAMID::leafShift;
+		const auto endRow = std::min(firstRow + POPULATION_PYRAMID::leafSide, region.end.row);
+		for (auto row = firstRow; row < endRow; ++row) {
+			const auto* cells = &m_Layout[Index(CELL_POSITION{ row, 0 })];
+			for (auto blockColumn = firstBlockColumn; blockColumn < endBlockColumn; ++blockColumn) {
+				const auto first = blockColumn << POPULATION_PYRAMID::leafShift;
+				const auto end = std::min(first + POPULATION_PYRAMID::leafSide, region.end.column);
+				auto count = std::uint8_t{ 0 };		// Twice the live cells, at most 32
+				if (end - first == POPULATION_PYRAMID::leafSide) {
+					// A full block row is two words of packed cells, so its ALIVE flags are masked & summed across bytes at once
+					constexpr auto aliveBytes = std::uint64_t{ 0x0101010101010101ull } * alive;
+					auto words = std::array<std::uint64_t, 2>{ };
+					std::memcpy(words.data(), &cells[first], sizeof(words));
+					count = static_cast<std::uint8_t>((((words[0] & aliveBytes) + (words[1] & aliveBytes)) * std::uint64_t{ 0x0101010101010101ull }) >> 56);
+				}
+				else {
+					for (auto column = first; column < end; ++column) { count = static_cast<std::uint8_t>(count + (cells[column].bits & alive)); }
+				}
+				leaves[blockColumn] = static_cast<std::uint16_t>(leaves[blockColumn] + (count >> 1));
 			}
 		}
 	}
 }
 
-const std::vector<CELL_POSITION>& ADJACENCY_LIST::operator[] (CELL_POSITION position) const noexcept {
-	return adjacencyList[position.row][position.column];
+void TIME_SLICE::RebuildPyramid() noexcept {
+	CountLeafBlocks(CELL_REGION{ CELL_POSITION{ }, CELL_POSITION{ m_Size.height, m_Size.width } });
+	SumPyramid();
+}
+
+[[nodiscard]] std::uint64_t TIME_SLICE::LiveCellsIn(CELL_REGION region) const noexcept {
+	region.end = CELL_POSITION{ std::min(region.end.row, m_Size.height), std::min(region.end.column, m_Size.width) };
+	if (region.first.row >= region.end.row || region.first.column >= region.end.column) { return 0; }
+	return LiveCellsIn(region, m_Pyramid.Levels() - 1, CELL_POSITION{ });
+}
+
+// Descend only into blocks the region's edge passes through
+[[nodiscard]] std::uint64_t TIME_SLICE::LiveCellsIn(CELL_REGION region, size_t level, CELL_POSITION block) const noexcept {
+	const auto side = POPULATION_PYRAMID::BlockSide(level);
+	const auto firstRow = block.row * side;
+	const auto firstColumn = block.column * side;
+	const auto endRow = std::min<size_t>(firstRow + side, m_Size.height);
+	const auto endColumn = std::min<size_t>(firstColumn + side, m_Size.width);
+	const auto overlap = CELL_REGION{
+		CELL_POSITION{ static_cast<unsigned int>(std::max<size_t>(firstRow, region.first.row)), static_cast<unsigned int>(std::max<size_t>(firstColumn, region.first.column)) },
+		CELL_POSITION{ static_cast<unsigned int>(std::min<size_t>(endRow, region.end.row)), static_cast<unsigned int>(std::min<size_t>(endColumn, region.end.column)) }
+	};
+	if (overlap.first.row >= overlap.end.row || overlap.first.column >= overlap.end.column) { return 0; }
+	if (overlap.first.row == firstRow && overlap.first.column == firstColumn && overlap.end.row == endRow && overlap.end.column == endColumn) {
+		return m_Pyramid.Count(level, block);
+	}
+
+	auto count = std::uint64_t{ 0 };
+	if (level == 0) {
+		for (auto position : ALL_CELL_POSITIONS{ BOARD_SIZE{ overlap.Width(), overlap.Height() } }) {
+			count += EnumHasFlag(LifeState(CELL_POSITION{ overlap.first.row + position.row, overlap.first.column + position.column }), LIFE_STATE::ALIVE) ? 1 : 0;
+		}
+		return count;
+	}
+	const auto below = m_Pyramid.LevelSize(level - 1);
+	for (auto row = block.row * 2; row < std::min(block.row * 2 + 2, below.height); ++row) {
+		for (auto column = block.column * 2; column < std::min(block.column * 2 + 2, below.width); ++column) {
+			count += LiveCellsIn(region, level - 1, CELL_POSITION{ row, column });
+		}
+	}
+	return count;
+}
+
+LIFE_HISTORY::LIFE_HISTORY(BOARD_SIZE size, std::shared_ptr<THREAD_POOL> pool)
+	: m_Size{ size },
+	m_Tiles{ TileBoard(size, rowsPerTile, std::max(size.width, 1u)) },
+	m_TemporalTiles{ TileBoard(size, temporalTileRows, temporalTileColumns) },
+	m_Pool{ std::move(pool) },
+	m_Latest{ std::make_shared<TIME_SLICE>(size) } {
+	PublishLatest();
+}
+
+THREAD_POOL& LIFE_HISTORY::Pool() const {
+	if (!m_Pool) { m_Pool = std::make_shared<THREAD_POOL>(THREAD_POOL::DefaultThreadCount(), m_Placement.firstTouch); }
+	return *m_Pool;
+}
+
+// Placed frames keep every tile with the thread that first wrote it, so that each band of rows stays on one node
+// Each tile records its own node & time, so the counters are only added up once the pool is done
+void LIFE_HISTORY::RunTiles(const std::vector<CELL_REGION>& tiles, size_t generations, const std::function<void(size_t)>& task) const noexcept {
+	auto samples = std::vector<std::pair<size_t, double>>(tiles.size());
+	auto timedTask = std::function<void(size_t)>{ [&](size_t tile) {
+		auto start = chrono::steady_clock::now();
+		task(tile);
+		samples[tile] = { THREAD_POOL::CurrentNode(), chrono::duration<double>(chrono::steady_clock::now() - start).count() };
+	} };
+	if (m_Placement.firstTouch) { Pool().ForEachOwned(tiles.size(), timedTask); }
+	else { Pool().ForEach(tiles.size(), timedTask); }
+
+	for (auto tile = size_t{ 0 }; tile < tiles.size(); ++tile) {
+		auto [node, seconds] = samples[tile];
+		if (node >= m_NodeStats.size()) { m_NodeStats.resize(node + 1); }
+		m_NodeStats[node].cells += tiles[tile].Width() * static_cast<std::uint64_t>(tiles[tile].Height()) * generations;
+		m_NodeStats[node].seconds += seconds;
+	}
+}
+
+std::vector<NODE_STATS> LIFE_HISTORY::NodeStats() const {
+	auto stats = m_NodeStats;
+	stats.resize(std::max(stats.size(), THREAD_POOL::NodeCount()));
+	return stats;
 }
 
 LIFE_STATE TIME_SLICE::PROXY_CELL::TogleDeadAlive() noexcept { 
-	auto flippedState = EnumToggleFlag(m_Cell->state, LIFE_STATE::ALIVE);
+	auto flippedState = EnumToggleFlag(m_Cell->State(), LIFE_STATE::ALIVE);
 	State(flippedState);
 	return flippedState;
 }
 
 TIME_SLICE::PROXY_CELL& TIME_SLICE::PROXY_CELL::State(LIFE_STATE state) noexcept {
-	auto increment = 0;
-	auto isAlive = EnumHasFlag(state, LIFE_STATE::ALIVE);
-	if (state == m_Cell->state) { return *this; }
-	else if (isAlive) { increment = 1; }
-	else { increment = -1; }
+	if (state == m_Cell->State()) { return *this; }
+	auto increment = EnumHasFlag(state, LIFE_STATE::ALIVE) ? 1 : -1;
 
 	// Update predicted next generation expected life state
-	if (m_Cell->neighborCount == 3 || m_Cell->neighborCount == 2 && isAlive) {
-		m_Cell->state = EnumAddFlag(state, LIFE_STATE::WILL_LIVE);
-	}
-	else { m_Cell->state = state; }
+	m_Cell->State(state);
+	m_Cell->bits = lifePredictionTable[m_Cell->bits];
 
 	if (m_Frame->status == STATUS::GENERATED) { m_Frame->status = STATUS::MANUALLY_CHANGED; }
+	m_Frame->m_Pyramid.Add(m_Position, increment);
 
-	for (auto& position: adjacencyList[m_Position]) {
-		auto& neighborCell = (*m_Frame).m_Layout[position.row][position.column];
-		neighborCell.neighborCount += increment;
+	auto updateNeighbor = [increment](CELL& neighborCell) {
+		neighborCell.NeighborCount(neighborCell.NeighborCount() + increment);
 
 		// Update predicted next generation expected life state
-		if (neighborCell.neighborCount == 3 || 
-			neighborCell.neighborCount == 2 && EnumHasFlag(neighborCell.state, LIFE_STATE::ALIVE)) {
-			neighborCell.state = EnumAddFlag(neighborCell.state, LIFE_STATE::WILL_LIVE);
-		}
-		else { neighborCell.state = EnumRemoveFlag(neighborCell.state, LIFE_STATE::WILL_LIVE); }
+		neighborCell.bits = lifePredictionTable[neighborCell.bits];
+	};
+
+	// The padding around the board must stay dead, so only edge cells take the bounds-checked path
+	if (m_Frame->IsInterior(m_Position)) {
+		for (auto offset : m_Frame->m_NeighborOffsets) { updateNeighbor(m_Cell[offset]); }
+	}
+	else {
+		for (auto& position : NEIGHBOR_POSITIONS{ m_Position, m_Frame->m_Size }) { updateNeighbor(m_Frame->m_Layout[m_Frame->Index(position)]); }
 	}
 	return *this;
 }
 
 [[nodiscard]] LIFE_STATE TIME_SLICE::LifeState(CELL_POSITION position) const noexcept {
-	return m_Layout[position.row][position.column].state;
+	return m_Layout[Index(position)].State();
 }
 
 [[nodiscard]] unsigned int TIME_SLICE::NeighborCount(CELL_POSITION position) const noexcept {
-	return m_Layout[position.row][position.column].neighborCount;
+	return m_Layout[Index(position)].NeighborCount();
 }
 
 [[nodiscard]] TIME_SLICE::PROXY_CELL TIME_SLICE::operator[] (CELL_POSITION position) noexcept {
-	return PROXY_CELL{ &m_Layout[position.row][position.column], position, this };
+	return PROXY_CELL{ &m_Layout[Index(position)], position, this };
 }
 
 // The cast-away of const **should** be safe
 // The result is const, so that should preserve the const-ness
 // Otherwise this doesn't work and this should be symetric with the non-const version
 [[nodiscard]] const TIME_SLICE::PROXY_CELL TIME_SLICE::operator[] (CELL_POSITION position) const noexcept {
-	return PROXY_CELL{ const_cast<CELL*>(&m_Layout[position.row][position.column]), position, const_cast<TIME_SLICE*>(this) };
+	return PROXY_CELL{ const_cast<CELL*>(&m_Layout[Index(position)]), position, const_cast<TIME_SLICE*>(this) };
+}
+
+[[nodiscard]] std::uint64_t TIME_SLICE::Hash() const noexcept {
+	auto hash = std::uint64_t{ 14695981039346656037ull };
+	for (auto& cell : m_Layout) { hash = (hash ^ cell.bits) * 1099511628211ull; }
+	return hash;
+}
+
+[[nodiscard]] bool TIME_SLICE::IsWellFormed() const noexcept {
+	constexpr auto maximumCount = std::uint8_t{ 8 };
+	for (auto index = size_t{ 0 }; index < m_Layout.size(); ++index) {
+		auto row = index / static_cast<size_t>(m_Stride);
+		auto column = index % static_cast<size_t>(m_Stride);
+		auto padding = row == 0 || row > m_Size.height || column == 0 || column > m_Size.width;
+		auto bits = m_Layout[index].bits;
+		if (padding ? bits != 0 : (bits >> CELL::countShift) > maximumCount) { return false; }
+	}
+	return true;
+}
+
+[[nodiscard]] size_t TIME_SLICE::MemoryBytes() const noexcept {
+	auto bytes = sizeof(*this) + m_Layout.capacity() * sizeof(CELL);
+	bytes += m_Pyramid.m_LevelSizes.capacity() * sizeof(BOARD_SIZE) + m_Pyramid.m_Leaves.capacity() * sizeof(std::uint16_t);
+	for (auto& level : m_Pyramid.m_Upper) { bytes += sizeof(level) + level.capacity() * sizeof(std::uint64_t); }
+	return bytes;
+}
+
+// Chunk k starts at entry firstChunkSize * (2^k - 1)
+[[nodiscard]] std::pair<size_t, size_t> LIFE_HISTORY::CHECKPOINT_LOG::Locate(size_t index) noexcept {
+	auto blocks = index / firstChunkSize + 1;
+	auto chunk = size_t{ 0 };
+	while (blocks >> (chunk + 1)) { ++chunk; }
+	return { chunk, index - firstChunkSize * ((size_t{ 1 } << chunk) - 1) };
+}
+
+LIFE_HISTORY::CHECKPOINT_LOG::CHECKPOINT_LOG(CHECKPOINT_LOG&& other) noexcept
+	: m_Chunks{ std::move(other.m_Chunks) },
+	m_Count{ other.m_Count.exchange(0) } { }
+
+LIFE_HISTORY::CHECKPOINT_LOG& LIFE_HISTORY::CHECKPOINT_LOG::operator=(CHECKPOINT_LOG&& other) noexcept {
+	m_Chunks = std::move(other.m_Chunks);
+	m_Count = other.m_Count.exchange(0);
+	return *this;
+}
+
+// The entry is complete before the count is released, so a reader never sees it half written
+void LIFE_HISTORY::CHECKPOINT_LOG::Append(size_t generation, FRAME_HANDLE frame) {
+	auto index = m_Count.load(std::memory_order_relaxed);
+	auto [chunk, offset] = Locate(index);
+	if (!m_Chunks[chunk]) { m_Chunks[chunk] = std::make_unique<ENTRY[]>(firstChunkSize << chunk); }
+	m_Chunks[chunk][offset] = ENTRY{ generation, std::move(frame) };
+	m_Count.store(index + 1, std::memory_order_release);
+}
+
+[[nodiscard]] const LIFE_HISTORY::CHECKPOINT_LOG::ENTRY& LIFE_HISTORY::CHECKPOINT_LOG::operator[] (size_t index) const noexcept {
+	auto [chunk, offset] = Locate(index);
+	return m_Chunks[chunk][offset];
+}
+
+[[nodiscard]] const LIFE_HISTORY::CHECKPOINT_LOG::ENTRY* LIFE_HISTORY::CHECKPOINT_LOG::FindAtOrBefore(size_t generation, size_t count) const noexcept {
+	auto first = size_t{ 0 };
+	while (first < count) {
+		auto middle = first + (count - first) / 2;
+		if ((*this)[middle].generation <= generation) { first = middle + 1; }
+		else { count = middle; }
+	}
+	return first == 0 ? nullptr : &(*this)[first - 1];
+}
+
+[[nodiscard]] std::shared_ptr<const LIFE_HISTORY::PUBLISHED_FRAME> LIFE_HISTORY::Published() const noexcept {
+	return m_Published.Load();
+}
+
+// Checkpoints are appended before the frame that follows them is published
+// A reader that sees a published generation therefore also sees every checkpoint before it
+void LIFE_HISTORY::PublishLatest() {
+	m_Published.Store(std::make_shared<const PUBLISHED_FRAME>(PUBLISHED_FRAME{ m_Generation, m_Latest }));
+	m_LatestPublished = true;
+}
+
+TIME_SLICE& LIFE_HISTORY::GetLatestGeneration() {
+	if (m_LatestPublished) {
+		m_Latest = std::make_shared<TIME_SLICE>(*m_Latest);
+		m_LatestPublished = false;
+	}
+	return *m_Latest;
+}
+
+// The latest frame becomes fixed once the history moves past it
+// Manual changes cannot be recomputed, so those frames must be kept as checkpoints
+void LIFE_HISTORY::KeepLatestGeneration() {
+	if (m_Latest->status == TIME_SLICE::STATUS::MANUALLY_CHANGED || m_Generation % checkpointInterval == 0 || m_Checkpoints.Count() == 0) {
+		m_Checkpoints.Append(m_Generation, m_Latest);
+	}
+	else { CacheGeneration(m_Generation, m_Latest); }
 }
 
 const TIME_SLICE& LIFE_HISTORY::Advance() noexcept {
-	CalculateNextGeneration();
-	return m_History.back();
+	KeepLatestGeneration();
+	m_Latest = std::make_shared<TIME_SLICE>(CalculateNextGeneration(*m_Latest));
+	++m_Generation;
+	PublishLatest();
+	return *m_Latest;
+}
+
+const TIME_SLICE& LIFE_HISTORY::Advance(size_t generations) noexcept {
+	if (generations <= 1 || m_Engine != ENGINE::SWEEP) {
+		for (auto i = size_t{ 0 }; i < generations; ++i) { Advance(); }
+		return *m_Latest;
+	}
+
+	// Blocks stop at every checkpoint interval on the way, so the checkpoints fall just as if each generation were stepped
+	// A skipped generation is then never more than an interval's worth of recomputation away
+	KeepLatestGeneration();
+	while (generations > 0) {
+		auto depth = std::min({ generations, m_TemporalDepth, checkpointInterval - m_Generation % checkpointInterval });
+		m_Latest = std::make_shared<TIME_SLICE>(depth == 1 ? CalculateNextGeneration(*m_Latest) : CalculateGenerationsAhead(*m_Latest, depth));
+		m_Generation += depth;
+		generations -= depth;
+		if (generations > 0 && m_Generation % checkpointInterval == 0) { m_Checkpoints.Append(m_Generation, m_Latest); }
+	}
+	PublishLatest();
+	return *m_Latest;
 }
 
 const TIME_SLICE& LIFE_HISTORY::operator[] (size_t generationNumber) const noexcept {
-	return m_History[generationNumber];
+	if (generationNumber >= m_Generation) { return *m_Latest; }
+	generationNumber = std::max(generationNumber, FirstGeneration());
+	if (generationNumber == m_Generation) { return *m_Latest; }
+	if (auto checkpoint = m_Checkpoints.FindAtOrBefore(generationNumber, m_Checkpoints.Count()); checkpoint->generation == generationNumber) { return *checkpoint->frame; }
+	if (auto cached = CachedGeneration(generationNumber)) { return *cached; }
+	return MaterializeGeneration(generationNumber);
 }
 
 [[nodiscard]] size_t LIFE_HISTORY::Generation() const noexcept {
-	return m_History.size() - 1;
+	return m_Generation;
+}
+
+[[nodiscard]] size_t LIFE_HISTORY::FirstGeneration() const noexcept {
+	return m_Checkpoints.Count() == 0 ? m_Generation : m_Checkpoints[0].generation;
+}
+
+void LIFE_HISTORY::Prefetch(size_t generationNumber, int direction) const noexcept {
+	if (direction > 0) {
+		auto last = std::min(generationNumber + prefetchDepth, m_Generation);
+		for (auto i = generationNumber + 1; i < last; ++i) { static_cast<void>((*this)[i]); }
+	}
+	else if (direction < 0) {
+		// Walk forward from the furthest target so each generation is computed only once
+		auto first = generationNumber > prefetchDepth ? generationNumber - prefetchDepth : 0;
+		for (auto i = first; i < generationNumber; ++i) { static_cast<void>((*this)[i]); }
+	}
+}
+
+[[nodiscard]] const TIME_SLICE* LIFE_HISTORY::CachedGeneration(size_t generationNumber) const noexcept {
+	auto entry = m_CacheIndex.find(generationNumber);
+	if (entry == m_CacheIndex.end()) { return nullptr; }
+	m_Cache.splice(m_Cache.begin(), m_Cache, entry->second);		// Mark as most recently used
+	return entry->second->second.get();
+}
+
+const TIME_SLICE& LIFE_HISTORY::CacheGeneration(size_t generationNumber, FRAME_HANDLE frame) const noexcept {
+	if (auto cached = CachedGeneration(generationNumber)) { return *cached; }
+	m_Cache.emplace_front(generationNumber, std::move(frame));
+	m_CacheIndex[generationNumber] = m_Cache.begin();
+	if (m_Cache.size() > cacheCapacity) {
+		m_CacheIndex.erase(m_Cache.back().first);
+		m_Cache.pop_back();
+	}
+	return *m_Cache.front().second;
+}
+
+// Recompute a generation from the closest known frame before it
+// Every generation passed along the way is cached, which also serves backward scrubbing
+const TIME_SLICE& LIFE_HISTORY::MaterializeGeneration(size_t generationNumber) const noexcept {
+	auto checkpoint = m_Checkpoints.FindAtOrBefore(generationNumber, m_Checkpoints.Count());
+	auto baseGeneration = checkpoint->generation;
+	const auto* frame = checkpoint->frame.get();
+	for (auto i = generationNumber; i > checkpoint->generation; --i) {
+		if (auto cached = CachedGeneration(i)) { baseGeneration = i; frame = cached; break; }
+	}
+
+	// Each new entry is inserted as most recently used, so the frame it was computed from is never the one evicted
+	for (auto i = baseGeneration + 1; i <= generationNumber; ++i) {
+		frame = &CacheGeneration(i, std::make_shared<const TIME_SLICE>(CalculateNextGeneration(*frame)));
+	}
+	return *frame;
 }
 
-unsigned int SurroundingCellNumber(const CELL_POSITION position, const TIME_SLICE& timeSlice) noexcept {
-	auto count = unsigned int{ 0 };
-	for (auto& pos: adjacencyList[position]) {
-		if (EnumHasFlag(timeSlice.LifeState(pos), LIFE_STATE::ALIVE)) {
-			++count;
+// Shared handle to any generation, advancing the history to reach a later one
+// A generation found or computed by operator[] is left at the front of the cache
+[[nodiscard]] LIFE_HISTORY::FRAME_HANDLE LIFE_HISTORY::StreamFrame(size_t generationNumber) noexcept {
+	if (generationNumber > m_Generation) { Advance(generationNumber - m_Generation); }
+	if (generationNumber >= m_Generation) {
+		if (!m_LatestPublished) { PublishLatest(); }		// Edits after this copy the frame first
+		return m_Latest;
+	}
+	if (auto checkpoint = m_Checkpoints.FindAtOrBefore(generationNumber, m_Checkpoints.Count()); checkpoint->generation == generationNumber) { return checkpoint->frame; }
+	static_cast<void>((*this)[generationNumber]);
+	return m_Cache.front().second;
+}
+
+LIFE_HISTORY::STREAM LIFE_HISTORY::Run(size_t from, size_t to, size_t stride) {
+	stride = std::max<size_t>(stride, 1);
+	for (auto number = std::max(from, FirstGeneration()); number < to; number += stride) {
+		auto generation = GENERATION{ number, StreamFrame(number) };
+		co_yield generation;
+		if (to - number <= stride) { break; }
+	}
+}
+
+// The next frame is always in flight on another thread, which is then the only one using the history
+// A loop left early waits for it when the stream is destroyed
+LIFE_HISTORY::STREAM LIFE_HISTORY::RunAsync(size_t from, size_t to, size_t stride) {
+	stride = std::max<size_t>(stride, 1);
+	auto number = std::max(from, FirstGeneration());
+	if (number >= to) { co_return; }
+	auto compute = [this](size_t generationNumber) { return std::async(std::launch::async, [this, generationNumber] { return StreamFrame(generationNumber); }); };
+	auto next = compute(number);
+	while (true) {
+		auto generation = GENERATION{ number, next.get() };
+		auto more = to - number > stride;
+		if (more) {
+			number += stride;
+			next = compute(number);
 		}
+		co_yield generation;
+		if (!more) { co_return; }
+	}
+}
+
+// Dead padding around the board contributes nothing to the count, so no cell needs special treatment
+[[nodiscard]] unsigned int TIME_SLICE::SurroundingCellNumber(const CELL* cell, LIFE_STATE flag) const noexcept {
+	auto count = 0u;
+	for (auto offset : m_NeighborOffsets) {
+		count += (cell[offset].bits & static_cast<std::uint8_t>(flag)) ? 1u : 0u;
 	}
 	return count;
 }
 
 void TIME_SLICE::SetNextCellState(const CELL_POSITION position, const TIME_SLICE& previousGeneration, TIME_SLICE& nextGeneration) noexcept {
 	// Next Life State
-	auto& nextState = nextGeneration[position].m_Cell->state;
-	auto& priorState = previousGeneration[position].m_Cell->state;
-	nextState = priorState >> 1u;
+	const auto& priorCell = previousGeneration.m_Layout[previousGeneration.Index(position)];
+	auto& nextCell = nextGeneration.m_Layout[nextGeneration.Index(position)];
+	nextCell.State(priorCell.State() >> 1u);
 
 	// Next Neighbor Count
-	auto& count = nextGeneration[position].m_Cell->neighborCount;
-	count = 0;
-	for (auto& pos : adjacencyList[position]) {
-		if (EnumHasFlag(previousGeneration.LifeState(pos), LIFE_STATE::WILL_LIVE)) {
-			++count;
-		}
-	}
+	nextCell.NeighborCount(previousGeneration.SurroundingCellNumber(&priorCell, LIFE_STATE::WILL_LIVE));
 }
 
 void TIME_SLICE::CalculateNeighborCount(const CELL_POSITION position, TIME_SLICE& nextGeneration) noexcept {
-	nextGeneration[position].m_Cell->neighborCount = SurroundingCellNumber(position, nextGeneration);
+	auto& cell = nextGeneration.m_Layout[nextGeneration.Index(position)];
+	cell.NeighborCount(nextGeneration.SurroundingCellNumber(&cell, LIFE_STATE::ALIVE));
 }
 
 void TIME_SLICE::CalculateNextLifeState(const CELL_POSITION position, TIME_SLICE& nextGeneration) noexcept {
-	auto neighborCount = nextGeneration.NeighborCount(position);
-	auto& state = nextGeneration[position].m_Cell->state;
-	if (neighborCount == 3 || neighborCount == 2 && EnumHasFlag(state, LIFE_STATE::ALIVE)) {
-		state = EnumAddFlag(state, LIFE_STATE::WILL_LIVE);
+	auto& cell = nextGeneration.m_Layout[nextGeneration.Index(position)];
+	cell.bits = lifePredictionTable[cell.bits];
+}
+
+// Advance a rectangle of a padded grid by one generation in a single sweep
+// Grids are addressed from their cell at (row 0, column 0) and must have a readable ring of cells around the region
+// A rolling window holds the WILL_LIVE flags of the rows above, at, and below the current row
+// Each previous row is gathered once (plus a halo row at either end) and each new row is written once
+// Counting loops are free of branches & lookups so the compiler can vectorize them
+void TIME_SLICE::SweepRegion(const CELL* previousGrid, CELL* nextGrid, const std::ptrdiff_t gridStride, const CELL_REGION region, std::vector<std::uint8_t>& scratch) noexcept {
+	const auto width = static_cast<std::ptrdiff_t>(region.Width());
+	const auto flagWidth = width + 2;
+	scratch.resize(static_cast<size_t>(flagWidth) * 3 + width);
+	auto* above = scratch.data();
+	auto* middle = above + flagWidth;
+	auto* below = middle + flagWidth;
+	auto* counts = below + flagWidth;
+
+	auto rowStart = [&](const CELL* grid, std::ptrdiff_t row) { return grid + row * gridStride + region.first.column; };
+	auto gatherWillLive = [flagWidth](std::uint8_t* flags, const CELL* cells) {
+		for (auto column = std::ptrdiff_t{ 0 }; column < flagWidth; ++column) { flags[column] = (cells[column - 1].bits >> 2u) & 1u; }
+	};
+	gatherWillLive(above, rowStart(previousGrid, std::ptrdiff_t{ region.first.row } - 1));
+	gatherWillLive(middle, rowStart(previousGrid, region.first.row));
+
+	for (auto row = std::ptrdiff_t{ region.first.row }; row < region.end.row; ++row) {
+		gatherWillLive(below, rowStart(previousGrid, row + 1));
+
+		for (auto column = std::ptrdiff_t{ 0 }; column < width; ++column) {
+			counts[column] = static_cast<std::uint8_t>(above[column] + above[column + 1] + above[column + 2]
+				+ middle[column] + middle[column + 2]
+				+ below[column] + below[column + 1] + below[column + 2]);
+		}
+
+		const auto* previousCells = rowStart(previousGrid, row);
+		auto* nextCells = nextGrid + row * gridStride + region.first.column;
+		for (auto column = std::ptrdiff_t{ 0 }; column < width; ++column) {
+			nextCells[column].bits = lifeTransitionTable[(previousCells[column].bits & CELL::stateMask) | (counts[column] << CELL::countShift)];
+		}
+
+		std::swap(above, middle);		// Roll the window down one row
+		std::swap(middle, below);
 	}
 }
 
-void LIFE_HISTORY::CalculateNextGeneration() noexcept {
-	auto nextGeneration = TIME_SLICE{ };
+// Flags are gathered across the dead padding too, so edge rows & columns take the same path
+void TIME_SLICE::SetNextTileState(const CELL_REGION tile, const TIME_SLICE& previousGeneration, TIME_SLICE& nextGeneration) noexcept {
+	thread_local auto scratch = std::vector<std::uint8_t>{ };
+	const auto origin = previousGeneration.Index(CELL_POSITION{ });
+	SweepRegion(&previousGeneration.m_Layout[origin], &nextGeneration.m_Layout[origin], previousGeneration.m_Stride, tile, scratch);
+	nextGeneration.CountLeafBlocks(tile);
+}
+
+// Temporal blocking: load a tile once with a halo as deep as the number of generations, then advance it that many times
+// Loaded edges on the board edge are exact, since everything beyond stays dead
+// Every other loaded edge corrupts one more ring of cells each generation, so the region computed shrinks to match
+// After the last generation exactly the tile itself remains valid and is written back
+void TIME_SLICE::AdvanceTileGenerations(const CELL_REGION tile, const size_t generations, const TIME_SLICE& previousGeneration, TIME_SLICE& finalGeneration) noexcept {
+	const auto size = previousGeneration.m_Size;
+	const auto halo = static_cast<unsigned int>(std::min<size_t>(generations, std::max(size.width, size.height)));
+	const auto loaded = CELL_REGION{
+		CELL_POSITION{ tile.first.row - std::min(halo, tile.first.row), tile.first.column - std::min(halo, tile.first.column) },
+		CELL_POSITION{ std::min(tile.end.row + halo, size.height), std::min(tile.end.column + halo, size.width) }
+	};
+	const auto shrinkTop = loaded.first.row > 0 ? 1u : 0u;
+	const auto shrinkLeft = loaded.first.column > 0 ? 1u : 0u;
+	const auto shrinkBottom = loaded.end.row < size.height ? 1u : 0u;
+	const auto shrinkRight = loaded.end.column < size.width ? 1u : 0u;
+
+	// Local copies are padded with dead cells just like a TIME_SLICE
+	const auto localStride = static_cast<std::ptrdiff_t>(loaded.Width()) + 2;
+	auto buffers = std::array<std::vector<CELL>, 2>{ };
+	for (auto& buffer : buffers) { buffer.resize(static_cast<size_t>(localStride) * (loaded.Height() + 2)); }
+	auto origin = [localStride](std::vector<CELL>& buffer) { return buffer.data() + localStride + 1; };
+
+	for (auto row = 0u; row < loaded.Height(); ++row) {
+		const auto* source = &previousGeneration.m_Layout[previousGeneration.Index(CELL_POSITION{ loaded.first.row + row, loaded.first.column })];
+		std::copy_n(source, loaded.Width(), origin(buffers[0]) + row * localStride);
+	}
+
+	auto scratch = std::vector<std::uint8_t>{ };
+	for (auto step = 1u; step <= generations; ++step) {
+		auto region = CELL_REGION{
+			CELL_POSITION{ shrinkTop * step, shrinkLeft * step },
+			CELL_POSITION{ loaded.Height() - shrinkBottom * step, loaded.Width() - shrinkRight * step }
+		};
+		SweepRegion(origin(buffers[(step - 1) % 2]), origin(buffers[step % 2]), localStride, region, scratch);
+	}
+
+	const auto* result = origin(buffers[generations % 2]);
+	for (auto row = tile.first.row; row < tile.end.row; ++row) {
+		const auto* source = result + (row - loaded.first.row) * localStride + (tile.first.column - loaded.first.column);
+		std::copy_n(source, tile.Width(), &finalGeneration.m_Layout[finalGeneration.Index(CELL_POSITION{ row, tile.first.column })]);
+	}
+	finalGeneration.CountLeafBlocks(tile);
+}
+
+[[nodiscard]] TIME_SLICE LIFE_HISTORY::CalculateNextGeneration(const TIME_SLICE& previousGeneration) const noexcept {
+	auto nextGeneration = TIME_SLICE{ m_Size, m_Engine == ENGINE::SWEEP ? m_Placement : MEMORY_PLACEMENT{ } };
 	nextGeneration.status = TIME_SLICE::STATUS::GENERATED;
-	const auto& previousGeneration = m_History.back();
 	
+	// Each tile manages its own scratch memory on whichever pool thread runs it
+	// The GUI board is too small to be worth splitting, & fits the compile-time sized sweep
+	if (m_Engine == ENGINE::SWEEP) {
+		if (m_FixedSizeKernel && m_Size == DEFAULT_FIXED_TIME_SLICE::size) { return DEFAULT_FIXED_TIME_SLICE{ previousGeneration }.Next().ToTimeSlice(); }
+		RunTiles(m_Tiles, 1, [&](size_t tile) { TIME_SLICE::SetNextTileState(m_Tiles[tile], previousGeneration, nextGeneration); });
+		nextGeneration.SumPyramid();
+		return nextGeneration;
+	}
+
 	// Advance the CELL state
 	// Then, compute the predicted next state after that
-	auto calc1 = [&](CELL_POSITION position) { TIME_SLICE::SetNextCellState(position, previousGeneration, nextGeneration); };
-	auto calc2 = [&](CELL_POSITION position) { TIME_SLICE::CalculateNextLifeState(position, nextGeneration); };
-	std::for_each(std::execution::par_unseq, allPositions.begin(), allPositions.end(), calc1);
-	std::for_each(std::execution::par_unseq, allPositions.begin(), allPositions.end(), calc2);
+	auto calc1 = [&](size_t tile) {
+		for (auto position : ALL_CELL_POSITIONS{ BOARD_SIZE{ m_Size.width, m_Tiles[tile].Height() } }) {
+			TIME_SLICE::SetNextCellState(CELL_POSITION{ position.row + m_Tiles[tile].first.row, position.column }, previousGeneration, nextGeneration);
+		}
+	};
+	auto calc2 = [&](size_t tile) {
+		for (auto position : ALL_CELL_POSITIONS{ BOARD_SIZE{ m_Size.width, m_Tiles[tile].Height() } }) {
+			TIME_SLICE::CalculateNextLifeState(CELL_POSITION{ position.row + m_Tiles[tile].first.row, position.column }, nextGeneration);
+		}
+		nextGeneration.CountLeafBlocks(m_Tiles[tile]);
+	};
+	Pool().ForEach(m_Tiles.size(), calc1);
+	Pool().ForEach(m_Tiles.size(), calc2);
+	nextGeneration.SumPyramid();
 
-	m_History.push_back(std::move(nextGeneration));
-	++m_Generation;
+	return nextGeneration;
+}
+
+// Readers share neither the pool nor the engine setting, which belong to the owning thread
+[[nodiscard]] TIME_SLICE LIFE_HISTORY::SweepNextGeneration(const TIME_SLICE& previousGeneration) const noexcept {
+	if (m_FixedSizeKernel && m_Size == DEFAULT_FIXED_TIME_SLICE::size) { return DEFAULT_FIXED_TIME_SLICE{ previousGeneration }.Next().ToTimeSlice(); }
+	auto nextGeneration = TIME_SLICE{ m_Size };
+	nextGeneration.status = TIME_SLICE::STATUS::GENERATED;
+	for (auto& tile : m_Tiles) { TIME_SLICE::SetNextTileState(tile, previousGeneration, nextGeneration); }
+	nextGeneration.SumPyramid();
+	return nextGeneration;
+}
+
+[[nodiscard]] size_t LIFE_HISTORY::READER::Generation() const noexcept {
+	return m_History->Published()->generation;
+}
+
+// Only frames the owner can no longer change are touched: checkpoints below the published count & the published latest
+[[nodiscard]] LIFE_HISTORY::FRAME_HANDLE LIFE_HISTORY::READER::operator[] (size_t generationNumber) {
+	auto published = m_History->Published();
+	if (generationNumber >= published->generation) { return published->frame; }
+
+	const auto& checkpoints = m_History->m_Checkpoints;
+	auto count = checkpoints.Count();
+	if (count == 0) { return published->frame; }
+	const auto* checkpoint = checkpoints.FindAtOrBefore(generationNumber, count);
+	if (checkpoint == nullptr) { return checkpoints[0].frame; }
+	if (checkpoint->generation == generationNumber) { return checkpoint->frame; }
+
+	// Start from whichever is closer, the checkpoint or a generation this reader computed before
+	auto baseGeneration = checkpoint->generation;
+	auto frame = checkpoint->frame;
+	if (auto cached = m_Cache.upper_bound(generationNumber); cached != m_Cache.begin() && std::prev(cached)->first > baseGeneration) {
+		std::tie(baseGeneration, frame) = *std::prev(cached);
+	}
+
+	for (auto i = baseGeneration + 1; i <= generationNumber; ++i) {
+		frame = std::make_shared<const TIME_SLICE>(m_History->SweepNextGeneration(*frame));
+		m_Cache.insert_or_assign(i, frame);
+	}
+
+	// Keep the generations nearest the one just read, the likeliest to be read next
+	auto distance = [generationNumber](size_t cached) { return cached > generationNumber ? cached - generationNumber : generationNumber - cached; };
+	while (m_Cache.size() > cacheCapacity) {
+		auto first = m_Cache.begin();
+		auto last = std::prev(m_Cache.end());
+		m_Cache.erase(distance(first->first) > distance(last->first) ? first : last);
+	}
+	return frame;
+}
+
+// Snapshot layout (native byte order)
+// Header: magic, version, board width & height, latest generation #, frame count
+// Frames: generation #, status, then the padded cell layout as raw bytes
+// The latest generation is always the final frame
+constexpr auto snapshotMagic = std::array<char, 4>{ 'K', 'G', 'L', 'H' };
+constexpr auto snapshotVersion = std::uint32_t{ 1 };
+constexpr auto snapshotCellLimit = std::uint64_t{ 1 } << 32;		// A 4 GiB frame, far beyond any board a snapshot is taken of
+
+// Bytes left to read, or the most a uint64_t holds where the stream cannot seek
+static std::uint64_t RemainingBytes(std::istream& stream) {
+	auto position = stream.tellg();
+	if (position == std::istream::pos_type(-1)) { return std::numeric_limits<std::uint64_t>::max(); }
+	stream.seekg(0, std::ios::end);
+	auto end = stream.tellg();
+	stream.clear();
+	stream.seekg(position);
+	if (!stream || end == std::istream::pos_type(-1) || end < position) { return std::numeric_limits<std::uint64_t>::max(); }
+	return static_cast<std::uint64_t>(end - position);
+}
+
+void LIFE_HISTORY::SaveHeader(std::ostream& stream, size_t width, size_t height, size_t generationNumber, size_t frameCount) {
+	stream.write(snapshotMagic.data(), snapshotMagic.size());
+	WriteBinary(stream, snapshotVersion);
+	WriteBinary(stream, static_cast<std::uint32_t>(width));
+	WriteBinary(stream, static_cast<std::uint32_t>(height));
+	WriteBinary(stream, static_cast<std::uint64_t>(generationNumber));
+	WriteBinary(stream, static_cast<std::uint64_t>(frameCount));
+}
+
+void LIFE_HISTORY::SaveFrameHeader(std::ostream& stream, size_t generationNumber, TIME_SLICE::STATUS status) {
+	WriteBinary(stream, static_cast<std::uint64_t>(generationNumber));
+	WriteBinary(stream, static_cast<std::uint8_t>(status));
+}
+
+void LIFE_HISTORY::Save(std::ostream& stream, bool includeHistory) const {
+	auto writeFrame = [&](size_t generationNumber, const TIME_SLICE& frame) {
+		SaveFrameHeader(stream, generationNumber, frame.status);
+		stream.write(reinterpret_cast<const char*>(frame.m_Layout.data()), frame.m_Layout.size() * sizeof(TIME_SLICE::CELL));
+	};
+
+	SaveHeader(stream, m_Size.width, m_Size.height, m_Generation, 1 + (includeHistory ? m_Checkpoints.Count() : 0));
+	if (includeHistory) {
+		for (auto i = size_t{ 0 }; i < m_Checkpoints.Count(); ++i) { writeFrame(m_Checkpoints[i].generation, *m_Checkpoints[i].frame); }
+	}
+	writeFrame(m_Generation, *m_Latest);
+	if (!stream) { throw std::runtime_error{ "Failed to write life history snapshot." }; }
+}
+
+[[nodiscard]] LIFE_HISTORY LIFE_HISTORY::Load(std::istream& stream, std::shared_ptr<THREAD_POOL> pool) {
+	auto magic = std::array<char, 4>{ };
+	stream.read(magic.data(), magic.size());
+	if (!stream || magic != snapshotMagic) { throw std::runtime_error{ "Not a life history snapshot." }; }
+	if (ReadBinary<std::uint32_t>(stream) != snapshotVersion) { throw std::runtime_error{ "Unsupported life history snapshot version." }; }
+	auto size = BOARD_SIZE{ ReadBinary<std::uint32_t>(stream), ReadBinary<std::uint32_t>(stream) };
+	if (!stream || size.CellCount() == 0) { throw std::runtime_error{ "Life history snapshot has no board." }; }
+	// A corrupt header must not decide how much is allocated, so the board has to be plausible & its first frame has to fit in the stream
+	auto frameBytes = (static_cast<std::uint64_t>(size.width) + 2) * (static_cast<std::uint64_t>(size.height) + 2) * sizeof(TIME_SLICE::CELL);
+	if (size.CellCount() > snapshotCellLimit || frameBytes > RemainingBytes(stream)) { throw std::runtime_error{ "Snapshot board size is invalid." }; }
+
+	auto history = LIFE_HISTORY{ size, std::move(pool) };
+	history.m_Generation = static_cast<size_t>(ReadBinary<std::uint64_t>(stream));
+	auto frameCount = ReadBinary<std::uint64_t>(stream);
+	if (!stream || frameCount == 0) { throw std::runtime_error{ "Truncated life history snapshot." }; }
+
+	for (auto i = std::uint64_t{ 0 }; i < frameCount; ++i) {
+		auto generationNumber = static_cast<size_t>(ReadBinary<std::uint64_t>(stream));
+		auto frame = TIME_SLICE{ size };
+		auto status = ReadBinary<std::uint8_t>(stream);
+		stream.read(reinterpret_cast<char*>(frame.m_Layout.data()), frame.m_Layout.size() * sizeof(TIME_SLICE::CELL));
+		if (!stream) { throw std::runtime_error{ "Truncated life history snapshot." }; }
+		if (status > static_cast<std::uint8_t>(TIME_SLICE::STATUS::MANUALLY_CHANGED)) { throw std::runtime_error{ "Unknown frame status in life history snapshot." }; }
+		if (!frame.IsWellFormed()) { throw std::runtime_error{ "Corrupt cell layout in life history snapshot." }; }
+		frame.status = static_cast<TIME_SLICE::STATUS>(status);
+		frame.RebuildPyramid();
+
+		auto isLatest = i + 1 == frameCount;
+		auto checkpoints = history.m_Checkpoints.Count();
+		auto outOfOrder = checkpoints > 0 && generationNumber <= history.m_Checkpoints[checkpoints - 1].generation;
+		if (isLatest != (generationNumber == history.m_Generation) || generationNumber > history.m_Generation || outOfOrder) {
+			throw std::runtime_error{ "Inconsistent life history snapshot." };
+		}
+		if (isLatest) { history.m_Latest = std::make_shared<TIME_SLICE>(std::move(frame)); }
+		else { history.m_Checkpoints.Append(generationNumber, std::make_shared<const TIME_SLICE>(std::move(frame))); }
+	}
+	history.PublishLatest();
+	return history;
+}
+
+[[nodiscard]] TIME_SLICE LIFE_HISTORY::CalculateGenerationsAhead(const TIME_SLICE& previousGeneration, size_t generations) const noexcept {
+	if (m_FixedSizeKernel && m_Size == DEFAULT_FIXED_TIME_SLICE::size) { return DEFAULT_FIXED_TIME_SLICE{ previousGeneration }.Advance(generations).ToTimeSlice(); }
+	auto finalGeneration = TIME_SLICE{ m_Size, m_Placement };
+	finalGeneration.status = TIME_SLICE::STATUS::GENERATED;
+	auto calc = [&](size_t tile) { TIME_SLICE::AdvanceTileGenerations(m_TemporalTiles[tile], generations, previousGeneration, finalGeneration); };
+	RunTiles(m_TemporalTiles, generations, calc);
+	finalGeneration.SumPyramid();
+	return finalGeneration;
 }
\ No newline at end of file
@@ -1,10 +1,7 @@
 #ifndef CELL_CLASS_H
 #define CELL_CLASS_H
 #include "framework.h"
-#include "WINDOW.h"
-
-constexpr auto layoutWidth = 25;
-constexpr auto layoutHeight = 25;
+#include "ThreadPool.h"
 
 struct CELL_POSITION {
 	constexpr CELL_POSITION() = default;
@@ -13,33 +10,82 @@ struct CELL_POSITION {
 	unsigned int column{ 0 };
 };
 
-struct ALL_CELL_POSITIONS{
-	friend class ADJACENCY_LIST;
-	ALL_CELL_POSITIONS();
-	const auto begin() const { return positions.cbegin(); }
-	const auto end() const { return positions.cend(); }
-private:
-	std::vector<CELL_POSITION> positions;
+// Rectangle of cells from the first position up to, but not including, the end position
+struct CELL_REGION {
+	CELL_POSITION first{ };
+	CELL_POSITION end{ };
+	[[nodiscard]] constexpr unsigned int Height() const noexcept { return end.row - first.row; }
+	[[nodiscard]] constexpr unsigned int Width() const noexcept { return end.column - first.column; }
 };
 
-class ADJACENCY_LIST {
-	std::vector<std::vector<std::vector<CELL_POSITION>>> adjacencyList{
-		layoutHeight, std::vector<std::vector<CELL_POSITION>>{ 
-			layoutWidth, std::vector<CELL_POSITION> { } 
-		} 
-	};
+// Dimensions of a board in cells, chosen per simulation at runtime
+struct BOARD_SIZE {
+	unsigned int width{ 25 };
+	unsigned int height{ 25 };
+	[[nodiscard]] constexpr size_t CellCount() const noexcept { return static_cast<size_t>(width) * height; }
+	[[nodiscard]] constexpr bool Contains(CELL_POSITION position) const noexcept { return position.row < height && position.column < width; }
+	[[nodiscard]] constexpr bool operator== (BOARD_SIZE other) const noexcept { return width == other.width && height == other.height; }
+	[[nodiscard]] constexpr bool operator!= (BOARD_SIZE other) const noexcept { return !(*this == other); }
+};
+
+inline constexpr auto defaultBoardSize = BOARD_SIZE{ 25, 25 };
+
+// Every position on a board in row-major order, generated on the fly rather than stored
+class ALL_CELL_POSITIONS {
+	BOARD_SIZE m_Size{ };
 public:
-	ADJACENCY_LIST();
-	const std::vector<CELL_POSITION>& operator[] (CELL_POSITION position) const noexcept;
+	class ITERATOR {
+		size_t m_Index{ 0 };
+		unsigned int m_Width{ 1 };
+	public:
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = CELL_POSITION;
+		using difference_type = std::ptrdiff_t;
+		using pointer = void;
+		using reference = CELL_POSITION;
+
+		constexpr ITERATOR() = default;
+		constexpr ITERATOR(size_t index, unsigned int width) noexcept : m_Index{ index }, m_Width{ width } { }
+		[[nodiscard]] constexpr CELL_POSITION operator* () const noexcept { return CELL_POSITION{ static_cast<unsigned int>(m_Index / m_Width), static_cast<unsigned int>(m_Index % m_Width) }; }
+		[[nodiscard]] constexpr CELL_POSITION operator[] (difference_type offset) const noexcept { return *(*this + offset); }
+		constexpr ITERATOR& operator++ () noexcept { ++m_Index; return *this; }
+		constexpr ITERATOR operator++ (int) noexcept { auto copy = *this; ++m_Index; return copy; }
+		constexpr ITERATOR& operator-- () noexcept { --m_Index; return *this; }
+		constexpr ITERATOR operator-- (int) noexcept { auto copy = *this; --m_Index; return copy; }
+		constexpr ITERATOR& operator+= (difference_type offset) noexcept { m_Index += offset; return *this; }
+		constexpr ITERATOR& operator-= (difference_type offset) noexcept { m_Index -= offset; return *this; }
+		[[nodiscard]] constexpr friend ITERATOR operator+ (ITERATOR it, difference_type offset) noexcept { return it += offset; }
+		[[nodiscard]] constexpr friend ITERATOR operator+ (difference_type offset, ITERATOR it) noexcept { return it += offset; }
+		[[nodiscard]] constexpr friend ITERATOR operator- (ITERATOR it, difference_type offset) noexcept { return it -= offset; }
+		[[nodiscard]] constexpr friend difference_type operator- (ITERATOR a, ITERATOR b) noexcept { return static_cast<difference_type>(a.m_Index) - static_cast<difference_type>(b.m_Index); }
+		[[nodiscard]] constexpr friend bool operator== (ITERATOR a, ITERATOR b) noexcept { return a.m_Index == b.m_Index; }
+		[[nodiscard]] constexpr friend bool operator!= (ITERATOR a, ITERATOR b) noexcept { return a.m_Index != b.m_Index; }
+		[[nodiscard]] constexpr friend bool operator< (ITERATOR a, ITERATOR b) noexcept { return a.m_Index < b.m_Index; }
+		[[nodiscard]] constexpr friend bool operator> (ITERATOR a, ITERATOR b) noexcept { return a.m_Index > b.m_Index; }
+		[[nodiscard]] constexpr friend bool operator<= (ITERATOR a, ITERATOR b) noexcept { return a.m_Index <= b.m_Index; }
+		[[nodiscard]] constexpr friend bool operator>= (ITERATOR a, ITERATOR b) noexcept { return a.m_Index >= b.m_Index; }
+	};
+
+	constexpr explicit ALL_CELL_POSITIONS(BOARD_SIZE size) noexcept : m_Size{ size } { }
+	[[nodiscard]] constexpr ITERATOR begin() const noexcept { return ITERATOR{ 0, m_Size.width }; }
+	[[nodiscard]] constexpr ITERATOR end() const noexcept { return ITERATOR{ m_Size.CellCount(), m_Size.width }; }
 };
 
-inline const ALL_CELL_POSITIONS allPositions;
-inline const ADJACENCY_LIST adjacencyList;
+// Positions surrounding a cell, computed by stencil arithmetic rather than stored
+// Cells along the edge of the board simply have fewer neighbors
+class NEIGHBOR_POSITIONS {
+	std::array<CELL_POSITION, 8> positions{ };
+	unsigned int count{ 0 };
+public:
+	NEIGHBOR_POSITIONS(CELL_POSITION position, BOARD_SIZE size) noexcept;
+	const auto begin() const { return positions.cbegin(); }
+	const auto end() const { return positions.cbegin() + count; }
+};
 
 // Tracks Alive/Dead for present generation, the immediately preceeding one, and the next one
 // Bit-masking is used to create composite states
 // Ordering of foundational states allows bitwise shift to move flags through time
-enum class LIFE_STATE {
+enum class LIFE_STATE : std::uint8_t {
 
 	// Foundational states
 	WAS_ALIVE = 1u,
@@ -69,14 +115,168 @@ inline LIFE_STATE operator>> (LIFE_STATE state, const unsigned int shift) {
 	return static_cast<LIFE_STATE>(static_cast<std::underlying_type_t<LIFE_STATE>>(state) >> shift);
 }
 
+// Birth & survival conditions as bitmasks over the neighbor count (bit n set => n neighbors qualifies)
+// Defaults to the standard rules: a dead cell with 3 neighbors will live, as will a living cell with 2 or 3
+struct LIFE_RULE {
+	std::uint16_t birth{ 1u << 3 };
+	std::uint16_t survival{ (1u << 2) | (1u << 3) };
+};
+
+// Packed cell byte layout shared by TIME_SLICE::CELL and the lookup tables below
+// Bits 0-2 hold the LIFE_STATE flags and bits 3-6 hold the neighbor count (0-8)
+inline constexpr std::uint8_t cellStateMask{ 0b0000'0111 };
+inline constexpr unsigned int cellCountShift{ 3u };
+
+// Apply the rule to a packed cell, replacing whatever WILL_LIVE flag it held
+constexpr std::uint8_t PredictNextLifeState(std::uint8_t cell, LIFE_RULE rule) noexcept {
+	constexpr auto aliveBit = static_cast<std::uint8_t>(LIFE_STATE::ALIVE);
+	constexpr auto willLiveBit = static_cast<std::uint8_t>(LIFE_STATE::WILL_LIVE);
+	auto neighborCount = cell >> cellCountShift;
+	auto conditions = (cell & aliveBit) ? rule.survival : rule.birth;
+	auto willLive = neighborCount < 16 && ((conditions >> neighborCount) & 1u);
+	return static_cast<std::uint8_t>((cell & ~willLiveBit) | (willLive ? willLiveBit : 0u));
+}
+
+// Prediction table indexed by a packed cell
+// Yields the same cell with its WILL_LIVE flag set from the present life state & neighbor count
+// Any WILL_LIVE flag already present in the index is ignored, so lookups may be repeated safely
+constexpr std::array<std::uint8_t, 256> MakePredictionTable(LIFE_RULE rule) noexcept {
+	auto table = std::array<std::uint8_t, 256>{ };
+	for (auto i = 0u; i < table.size(); ++i) { table[i] = PredictNextLifeState(static_cast<std::uint8_t>(i), rule); }
+	return table;
+}
+
+// Transition table indexed by a cell's previous life state & its new neighbor count, packed as a cell
+// Yields the next generation's cell: history flags shifted forward in time plus the WILL_LIVE prediction
+constexpr std::array<std::uint8_t, 256> MakeTransitionTable(LIFE_RULE rule) noexcept {
+	auto table = std::array<std::uint8_t, 256>{ };
+	for (auto i = 0u; i < table.size(); ++i) {
+		auto shifted = ((i & cellStateMask) >> 1u) | (i & ~cellStateMask);
+		table[i] = PredictNextLifeState(static_cast<std::uint8_t>(shifted), rule);
+	}
+	return table;
+}
+
+inline constexpr auto lifePredictionTable = MakePredictionTable(LIFE_RULE{ });
+inline constexpr auto lifeTransitionTable = MakeTransitionTable(LIFE_RULE{ });
+
+// Live cell counts of a board at every scale, like the mip-map of an image
+// Level 0 counts each leafSide x leafSide block of cells, & every level above sums 2x2 blocks of the level below
+// The top level is a single block holding the whole population
+// A zoomed-out view reads the level matching its scale instead of visiting every cell
+class POPULATION_PYRAMID {
+	friend class TIME_SLICE;
+public:
+	static constexpr unsigned int leafShift{ 4 };
+	static constexpr unsigned int leafSide{ 1u << leafShift };
+private:
+	std::vector<BOARD_SIZE> m_LevelSizes{ };				// In blocks
+	std::vector<std::uint16_t> m_Leaves{ };
+	std::vector<std::vector<std::uint64_t>> m_Upper{ };		// Level 1 & up
+
+	void Add(CELL_POSITION cell, int delta) noexcept;
+	void SumUpperLevels() noexcept;
+public:
+	POPULATION_PYRAMID() = default;
+	explicit POPULATION_PYRAMID(BOARD_SIZE size);
+
+	[[nodiscard]] size_t Levels() const noexcept { return m_LevelSizes.size(); }
+	[[nodiscard]] BOARD_SIZE LevelSize(size_t level) const noexcept { return m_LevelSizes[level]; }
+	[[nodiscard]] static constexpr size_t BlockSide(size_t level) noexcept { return size_t{ leafSide } << level; }
+
+	// Live cells in one block of a level
+	[[nodiscard]] std::uint64_t Count(size_t level, CELL_POSITION block) const noexcept;
+	[[nodiscard]] std::uint64_t Population() const noexcept { return Count(Levels() - 1, CELL_POSITION{ }); }
+};
+
+// Where the cells of computed frames live (see LIFE_HISTORY::Placement)
+struct MEMORY_PLACEMENT {
+	bool firstTouch{ false };	// Each band of rows is first written, & so placed on its NUMA node, by the pinned pool thread that computes it every generation
+	bool hugePages{ false };	// Ask for frames to be backed by transparent huge pages (Linux only)
+	[[nodiscard]] bool Mapped() const noexcept { return firstTouch || hugePages; }
+};
+
+// Work done by the pool threads while running on one NUMA node
+struct NODE_STATS {
+	std::uint64_t cells{ 0 };	// Cell updates
+	double seconds{ 0.0 };		// Thread time spent on them
+};
+
+// Pages mapped straight from the system, which reads as zero & is only backed by memory where first written
+// Throws std::bad_alloc when out of address space
+[[nodiscard]] void* MapFrameMemory(size_t bytes, bool hugePages);
+void UnmapFrameMemory(void* memory, size_t bytes) noexcept;
+
+// Allocator for frame layouts
+// A mapped layout is left unwritten, as fresh pages are already zero, so the first writer of each page is the thread computing it
+// Other layouts are ordinary zeroed heap memory, as are all copies
+template <class T>
+class FRAME_ALLOCATOR {
+	MEMORY_PLACEMENT m_Placement{ };
+public:
+	using value_type = T;
+	using propagate_on_container_move_assignment = std::true_type;
+	using propagate_on_container_swap = std::true_type;
+
+	FRAME_ALLOCATOR() = default;
+	explicit FRAME_ALLOCATOR(MEMORY_PLACEMENT placement) noexcept : m_Placement{ placement } { }
+	template <class U> FRAME_ALLOCATOR(const FRAME_ALLOCATOR<U>& other) noexcept : m_Placement{ other.Placement() } { }
+	[[nodiscard]] MEMORY_PLACEMENT Placement() const noexcept { return m_Placement; }
+	[[nodiscard]] FRAME_ALLOCATOR select_on_container_copy_construction() const noexcept { return FRAME_ALLOCATOR{ }; }
+
+	[[nodiscard]] T* allocate(size_t count) {
+		if (!m_Placement.Mapped()) { return std::allocator<T>{ }.allocate(count); }
+		return static_cast<T*>(MapFrameMemory(count * sizeof(T), m_Placement.hugePages));
+	}
+	void deallocate(T* memory, size_t count) noexcept {
+		if (!m_Placement.Mapped()) { std::allocator<T>{ }.deallocate(memory, count); }
+		else { UnmapFrameMemory(memory, count * sizeof(T)); }
+	}
+
+	template <class U, class... ARGS> void construct(U* memory, ARGS&&... args) { ::new (static_cast<void*>(memory)) U(std::forward<ARGS>(args)...); }
+	template <class U> void construct(U* memory) {
+		if (!m_Placement.Mapped()) { ::new (static_cast<void*>(memory)) U(); }
+	}
+
+	[[nodiscard]] friend bool operator== (const FRAME_ALLOCATOR& a, const FRAME_ALLOCATOR& b) noexcept { return a.m_Placement.Mapped() == b.m_Placement.Mapped(); }
+	[[nodiscard]] friend bool operator!= (const FRAME_ALLOCATOR& a, const FRAME_ALLOCATOR& b) noexcept { return !(a == b); }
+};
+
 class TIME_SLICE {
 	friend class LIFE_HISTORY;
+	friend class STRIP_WORKER;
+	template <unsigned int Width, unsigned int Height> friend class FIXED_TIME_SLICE;
+
+	// Each CELL is packed into a single byte (see cellStateMask & cellCountShift)
+	// This keeps a whole generation (and each stored frame of history) at one byte per cell
 	struct CELL {
-		LIFE_STATE state{ LIFE_STATE::STABLE_DEAD };
-		unsigned int neighborCount{ 0 };
+		static constexpr std::uint8_t stateMask{ cellStateMask };
+		static constexpr unsigned int countShift{ cellCountShift };
+		std::uint8_t bits{ 0 };
+
+		[[nodiscard]] LIFE_STATE State() const noexcept { return static_cast<LIFE_STATE>(bits & stateMask); }
+		[[nodiscard]] unsigned int NeighborCount() const noexcept { return bits >> countShift; }
+		void State(LIFE_STATE state) noexcept { bits = (bits & ~stateMask) | (static_cast<std::uint8_t>(state) & stateMask); }
+		void NeighborCount(unsigned int count) noexcept { bits = static_cast<std::uint8_t>((bits & stateMask) | (count << countShift)); }
 	};
-	std::vector<std::vector<CELL>> m_Layout{ layoutHeight, std::vector<CELL>{ layoutWidth, CELL{ } } };
+
+	// The layout is padded with a ring of permanently dead cells
+	// Any cell on the board can then reach all 8 neighbors through fixed stencil offsets without bounds checks
+	BOARD_SIZE m_Size{ };
+	std::ptrdiff_t m_Stride{ 0 };
+	std::array<std::ptrdiff_t, 8> m_NeighborOffsets{ };
+	std::vector<CELL, FRAME_ALLOCATOR<CELL>> m_Layout{ };
+	POPULATION_PYRAMID m_Pyramid{ };
+	[[nodiscard]] size_t Index(CELL_POSITION position) const noexcept { return static_cast<size_t>(position.row + 1) * m_Stride + position.column + 1; }
+	[[nodiscard]] bool IsInterior(CELL_POSITION position) const noexcept {
+		return position.row > 0 && position.row + 1 < m_Size.height && position.column > 0 && position.column + 1 < m_Size.width;
+	}
+	// Whether the layout could have come from this engine: a dead padding ring, & no cell bits beyond a count of 8 or the state flags
+	[[nodiscard]] bool IsWellFormed() const noexcept;
+	TIME_SLICE(BOARD_SIZE size, MEMORY_PLACEMENT placement);
 public:
+	explicit TIME_SLICE(BOARD_SIZE size = defaultBoardSize);
+
 	enum class STATUS {
 		GENERATED = 0,
 		MANUALLY_CHANGED = 1
@@ -96,17 +296,45 @@ public:
 	private:
 		PROXY_CELL& State(LIFE_STATE state) noexcept;
 	public:
-		[[nodiscard]] LIFE_STATE State() const noexcept { return m_Cell->state; }
-		[[nodiscard]] unsigned int NeighborCount() const noexcept { return m_Cell->neighborCount; }
+		[[nodiscard]] LIFE_STATE State() const noexcept { return m_Cell->State(); }
+		[[nodiscard]] unsigned int NeighborCount() const noexcept { return m_Cell->NeighborCount(); }
 	};
 
 	STATUS status{ STATUS::MANUALLY_CHANGED };
+	[[nodiscard]] BOARD_SIZE Size() const noexcept { return m_Size; }
+	[[nodiscard]] ALL_CELL_POSITIONS Positions() const noexcept { return ALL_CELL_POSITIONS{ m_Size }; }
 	[[nodiscard]] LIFE_STATE LifeState(CELL_POSITION position) const noexcept;
 	[[nodiscard]] unsigned int NeighborCount(CELL_POSITION position) const noexcept;
 	[[nodiscard]] PROXY_CELL operator[] (CELL_POSITION position) noexcept;
 	[[nodiscard]] const PROXY_CELL operator[] (CELL_POSITION position) const noexcept;
 
+	// Kept current through edits & every generation update
+	[[nodiscard]] const POPULATION_PYRAMID& Pyramid() const noexcept { return m_Pyramid; }
+	[[nodiscard]] std::uint64_t Population() const noexcept { return m_Pyramid.Population(); }
+
+	// Live cells within a region, clipped to the board
+	// Blocks lying wholly inside are counted from the pyramid, so the cost follows the region's perimeter, not its area
+	[[nodiscard]] std::uint64_t LiveCellsIn(CELL_REGION region) const noexcept;
+
+	// Fingerprint of every cell's life state & neighbor count (FNV-1a)
+	// Equal frames always hash equal, so this serves to check that two runs stayed bit-identical
+	[[nodiscard]] std::uint64_t Hash() const noexcept;
+
+	// Bytes held by the frame, its padded layout & population pyramid included
+	[[nodiscard]] size_t MemoryBytes() const noexcept;
+
 private:
+	[[nodiscard]] std::uint64_t LiveCellsIn(CELL_REGION region, size_t level, CELL_POSITION block) const noexcept;
+
+	// The region must start on a leaf block boundary & end on one or at the board edge
+	void CountLeafBlocks(CELL_REGION region) noexcept;
+	void SumPyramid() noexcept { m_Pyramid.SumUpperLevels(); }
+	void RebuildPyramid() noexcept;
+
+	static void SweepRegion(const CELL* previousGrid, CELL* nextGrid, const std::ptrdiff_t gridStride, const CELL_REGION region, std::vector<std::uint8_t>& scratch) noexcept;
+	static void SetNextTileState(const CELL_REGION tile, const TIME_SLICE& previousGeneration, TIME_SLICE& nextGeneration) noexcept;
+	static void AdvanceTileGenerations(const CELL_REGION tile, const size_t generations, const TIME_SLICE& previousGeneration, TIME_SLICE& finalGeneration) noexcept;
+	[[nodiscard]] unsigned int SurroundingCellNumber(const CELL* cell, LIFE_STATE flag) const noexcept;
 	static void SetNextCellState(const CELL_POSITION position, const TIME_SLICE& previousGeneration, TIME_SLICE& nextGeneration) noexcept;
 	static void CalculateNeighborCount(const CELL_POSITION position, TIME_SLICE& nextGeneration) noexcept;
 	static void CalculateNextLifeState(const CELL_POSITION position, TIME_SLICE& nextGeneration) noexcept;
@@ -117,21 +345,279 @@ private:
 // <s> Use of contstants also greatly simplifies multithreading </s>
 // Manual changes by the user will be accomplished by adding a new frame with the change
 // 
+// Because each generated frame is deterministic, only checkpoints are stored in full
+// A checkpoint is kept every checkpointInterval generations and for every manually changed frame
+// Any other generation is recomputed on demand from the nearest checkpoint
+// Recently viewed generations are held in a small least-recently-used cache
+//
+// Each LIFE_HISTORY is a self-contained simulation: it owns its board size, frames, tiling, and thread pool
+// Any number of them, of any sizes, may run at once on separate threads
+//
+// One owning thread advances & edits the history, and only it may call the non-static members below
+// Other threads read through a READER, which hands out FRAME_HANDLEs that stay valid however far the owner moves on
 class LIFE_HISTORY {
-	std::vector<TIME_SLICE> m_History{ 1, TIME_SLICE{ } };
-	unsigned long m_Generation{ 0 };
+public:
+	// Available implementations of the generation update, all producing identical frames
+	enum class ENGINE {
+		REFERENCE = 0,		// Per-cell two-pass update through the neighbor stencil
+		SWEEP = 1			// Single cache-blocked sweep driven by the constexpr transition table
+	};
+
+	// Shared ownership of a frame that no one will ever change again
+	using FRAME_HANDLE = std::shared_ptr<const TIME_SLICE>;
+
+	// A generation handed out by a STREAM
+	struct GENERATION {
+		size_t number{ 0 };
+		FRAME_HANDLE frame{ };
+	};
+
+	class READER;
+	class STREAM;
+private:
+	static constexpr size_t checkpointInterval{ 32 };
+	static constexpr size_t cacheCapacity{ 64 };
+	static constexpr size_t prefetchDepth{ 8 };
+
+	// Append-only list of checkpoints in increasing generation order
+	// Entries live in chunks that never move, so readers may search the published entries while the owner appends
+	// Chunk k holds firstChunkSize * 2^k entries, enough chunks for any history that fits in memory
+	class CHECKPOINT_LOG {
+	public:
+		struct ENTRY {
+			size_t generation{ 0 };
+			FRAME_HANDLE frame{ };
+		};
+	private:
+		static constexpr size_t firstChunkSize{ 64 };
+		std::array<std::unique_ptr<ENTRY[]>, 48> m_Chunks{ };
+		std::atomic<size_t> m_Count{ 0 };
+		[[nodiscard]] static std::pair<size_t, size_t> Locate(size_t index) noexcept;
+	public:
+		CHECKPOINT_LOG() = default;
+		CHECKPOINT_LOG(CHECKPOINT_LOG&& other) noexcept;
+		CHECKPOINT_LOG& operator=(CHECKPOINT_LOG&& other) noexcept;
+
+		// Owning thread only; the generation must be later than every one already recorded
+		void Append(size_t generation, FRAME_HANDLE frame);
+
+		// Safe from any thread
+		[[nodiscard]] size_t Count() const noexcept { return m_Count.load(std::memory_order_acquire); }
+		[[nodiscard]] const ENTRY& operator[] (size_t index) const noexcept;
+
+		// Latest checkpoint at or before the generation, among the first "count" entries (null if none)
+		[[nodiscard]] const ENTRY* FindAtOrBefore(size_t generation, size_t count) const noexcept;
+	};
+
+	// Latest generation as last published to readers
+	struct PUBLISHED_FRAME {
+		size_t generation{ 0 };
+		FRAME_HANDLE frame{ };
+	};
+
+	// Handle to the published frame, exchanged under a lock held only to copy or swap the handle
+	// Not std::atomic<std::shared_ptr>: GCC 12's releases its internal lock after a load without ordering, a data race ThreadSanitizer reports
+	// A mutex cannot move, so like CHECKPOINT_LOG this spells out the moves a LIFE_HISTORY needs (see Load)
+	class PUBLISHED_SLOT {
+		mutable std::mutex m_Mutex{ };
+		std::shared_ptr<const PUBLISHED_FRAME> m_Frame{ };
+	public:
+		PUBLISHED_SLOT() = default;
+		PUBLISHED_SLOT(PUBLISHED_SLOT&& other) noexcept : m_Frame{ other.Load() } { }
+		PUBLISHED_SLOT& operator=(PUBLISHED_SLOT&& other) noexcept { Store(other.Load()); return *this; }
+
+		[[nodiscard]] std::shared_ptr<const PUBLISHED_FRAME> Load() const noexcept {
+			auto lock = std::lock_guard{ m_Mutex };
+			return m_Frame;
+		}
+		// The previous frame is swapped into the parameter, so its release happens after the lock is dropped
+		void Store(std::shared_ptr<const PUBLISHED_FRAME> frame) noexcept {
+			auto lock = std::lock_guard{ m_Mutex };
+			m_Frame.swap(frame);
+		}
+	};
+
+	BOARD_SIZE m_Size{ };
+	std::vector<CELL_REGION> m_Tiles{ };			// Units of parallel work, single generation
+	std::vector<CELL_REGION> m_TemporalTiles{ };	// Units of parallel work, several generations
+	mutable std::shared_ptr<THREAD_POOL> m_Pool{ };	// Started on first use when not supplied
+	CHECKPOINT_LOG m_Checkpoints{ };
+	std::shared_ptr<TIME_SLICE> m_Latest{ };
+	bool m_LatestPublished{ false };				// Readers may hold m_Latest, so the next edit must copy it first
+	PUBLISHED_SLOT m_Published{ };
+	size_t m_Generation{ 0 };
+	ENGINE m_Engine{ ENGINE::SWEEP };
+	size_t m_TemporalDepth{ 8 };
+	bool m_FixedSizeKernel{ true };
+	MEMORY_PLACEMENT m_Placement{ };
+	mutable std::vector<NODE_STATS> m_NodeStats{ };	// By node
+
+	// Most recently used generation at the front
+	mutable std::list<std::pair<size_t, FRAME_HANDLE>> m_Cache{ };
+	mutable std::unordered_map<size_t, std::list<std::pair<size_t, FRAME_HANDLE>>::iterator> m_CacheIndex{ };
 
 public:
+	// Pass a pool to share threads between simulations, otherwise the history starts its own when first needed
+	explicit LIFE_HISTORY(BOARD_SIZE size = defaultBoardSize, std::shared_ptr<THREAD_POOL> pool = nullptr);
+
+	[[nodiscard]] BOARD_SIZE Size() const noexcept { return m_Size; }
 	const TIME_SLICE& Advance() noexcept;
-	TIME_SLICE& GetLatestGeneration() noexcept { return m_History.back(); }
+
+	// Jump ahead several generations without recording the ones in between
+	// The SWEEP engine advances each tile TemporalDepth() generations per trip through memory
+	// Skipped generations remain available, recomputed on demand like any other; blocks end on checkpoint intervals, which are kept as usual
+	const TIME_SLICE& Advance(size_t generations) noexcept;
+
+	// The latest generation, open for edits
+	// Readers keep seeing the generation as it was when last published, until the owner calls PublishLatest or advances
+	TIME_SLICE& GetLatestGeneration();
+	void PublishLatest();
 
 	// Get layout of generation #
+	// The reference is only guaranteed until the next call into this LIFE_HISTORY
 	const TIME_SLICE& operator[] (size_t generationNumber) const noexcept;
 
+	// Generations from, from + stride, ... up to but not including to, produced only as a range-for loop asks for them
+	// Those already on record are looked up, later ones computed by advancing the history (stride > 1 jumps ahead)
+	// Frames are shared rather than copied, so a GENERATION stays valid after the loop moves on
+	// Until the stream is destroyed, it alone may use the history
+	[[nodiscard]] STREAM Run(size_t from, size_t to, size_t stride = 1);
+
+	// As Run, but each generation is computed on another thread while the loop body still works on the one before
+	// Worthwhile once a generation takes longer than starting a thread
+	[[nodiscard]] STREAM RunAsync(size_t from, size_t to, size_t stride = 1);
+
 	// Get generation count
 	[[nodiscard]] size_t Generation() const noexcept;
+
+	// Earliest generation still on record (nonzero for a history restored without its past)
+	[[nodiscard]] size_t FirstGeneration() const noexcept;
+
+	// Compute the generations following a scrub direction (+/-) ahead of time
+	// Holding a step key then only ever hits the cache
+	void Prefetch(size_t generationNumber, int direction) const noexcept;
+
+	// Select the generation update implementation
+	LIFE_HISTORY& Engine(ENGINE engine) noexcept { m_Engine = engine; return *this; }
+	[[nodiscard]] ENGINE Engine() const noexcept { return m_Engine; }
+
+	// Generations computed per tile load when jumping ahead
+	// Deeper blocks save memory traffic but recompute a wider halo around every tile
+	LIFE_HISTORY& TemporalDepth(size_t depth) noexcept { m_TemporalDepth = std::max<size_t>(depth, 1); return *this; }
+	[[nodiscard]] size_t TemporalDepth() const noexcept { return m_TemporalDepth; }
+
+	// Whether the SWEEP engine hands boards the size of DEFAULT_FIXED_TIME_SLICE to its compile-time sized kernel
+	// Turned off, those boards run the tiled sweep like any other, so that it can be checked & timed at that size too
+	LIFE_HISTORY& FixedSizeKernel(bool use) noexcept { m_FixedSizeKernel = use; return *this; }
+	[[nodiscard]] bool FixedSizeKernel() const noexcept { return m_FixedSizeKernel; }
+
+	// Placement of the frames the SWEEP engine computes, for boards much larger than the caches
+	// With firstTouch, each pool thread always computes the same band of rows & so writes it first, putting its pages on that thread's node
+	// Set it before the first generation for the history's own pool to be started pinned
+	// A supplied pool should be pinned, & must not be running this history's generations from inside one of its own tasks
+	LIFE_HISTORY& Placement(MEMORY_PLACEMENT placement) noexcept { m_Placement = placement; return *this; }
+	[[nodiscard]] MEMORY_PLACEMENT Placement() const noexcept { return m_Placement; }
+
+	// Cell updates & thread time of the SWEEP engine on each NUMA node, by node, since the last reset
+	[[nodiscard]] std::vector<NODE_STATS> NodeStats() const;
+	void ResetNodeStats() noexcept { m_NodeStats.clear(); }
+
+	// Binary snapshot of the latest generation, optionally preceded by every stored checkpoint
+	// Frames are written as raw cell layouts so that loading is a handful of bulk reads
+	// Load takes the board size from the snapshot & throws std::runtime_error on a malformed or unsupported one
+	// Each frame's status & cell bytes are checked too, so a corrupt layout is rejected rather than simulated
+	void Save(std::ostream& stream, bool includeHistory) const;
+	[[nodiscard]] static LIFE_HISTORY Load(std::istream& stream, std::shared_ptr<THREAD_POOL> pool = nullptr);
+
+	// Snapshot header & frame prefix, also used to write boards assembled elsewhere in the same format
+	// A frame prefix is followed by the padded cell layout, (height + 2) rows of (width + 2) cells
+	static void SaveHeader(std::ostream& stream, size_t width, size_t height, size_t generationNumber, size_t frameCount);
+	static void SaveFrameHeader(std::ostream& stream, size_t generationNumber, TIME_SLICE::STATUS status);
 private:
-	void CalculateNextGeneration() noexcept;
+	[[nodiscard]] TIME_SLICE CalculateNextGeneration(const TIME_SLICE& previousGeneration) const noexcept;
+	[[nodiscard]] TIME_SLICE SweepNextGeneration(const TIME_SLICE& previousGeneration) const noexcept;
+	[[nodiscard]] TIME_SLICE CalculateGenerationsAhead(const TIME_SLICE& previousGeneration, size_t generations) const noexcept;
+	[[nodiscard]] THREAD_POOL& Pool() const;
+	void RunTiles(const std::vector<CELL_REGION>& tiles, size_t generations, const std::function<void(size_t)>& task) const noexcept;
+	void KeepLatestGeneration();
+	[[nodiscard]] std::shared_ptr<const PUBLISHED_FRAME> Published() const noexcept;
+	[[nodiscard]] const TIME_SLICE* CachedGeneration(size_t generationNumber) const noexcept;
+	const TIME_SLICE& CacheGeneration(size_t generationNumber, FRAME_HANDLE frame) const noexcept;
+	const TIME_SLICE& MaterializeGeneration(size_t generationNumber) const noexcept;
+	[[nodiscard]] FRAME_HANDLE StreamFrame(size_t generationNumber) noexcept;
+};
+
+// Range of generations produced lazily by a coroutine (see LIFE_HISTORY::Run)
+// The iterator is single pass: each increment resumes the coroutine until it yields the next generation
+class LIFE_HISTORY::STREAM {
+public:
+	struct promise_type {
+		const GENERATION* current{ nullptr };
+
+		[[nodiscard]] STREAM get_return_object() noexcept { return STREAM{ std::coroutine_handle<promise_type>::from_promise(*this) }; }
+		[[nodiscard]] std::suspend_always initial_suspend() const noexcept { return { }; }
+		[[nodiscard]] std::suspend_always final_suspend() const noexcept { return { }; }
+		std::suspend_always yield_value(const GENERATION& generation) noexcept { current = &generation; return { }; }
+		void return_void() const noexcept { }
+		void unhandled_exception() const { throw; }
+	};
+
+	class ITERATOR {
+		std::coroutine_handle<promise_type> m_Coroutine{ };
+	public:
+		using iterator_category = std::input_iterator_tag;
+		using value_type = GENERATION;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const GENERATION*;
+		using reference = const GENERATION&;
+
+		ITERATOR() = default;
+		explicit ITERATOR(std::coroutine_handle<promise_type> coroutine) noexcept : m_Coroutine{ coroutine } { }
+		[[nodiscard]] reference operator* () const noexcept { return *m_Coroutine.promise().current; }
+		[[nodiscard]] pointer operator-> () const noexcept { return m_Coroutine.promise().current; }
+		ITERATOR& operator++ () { m_Coroutine.resume(); return *this; }
+		void operator++ (int) { ++*this; }
+		[[nodiscard]] friend bool operator== (const ITERATOR& it, std::default_sentinel_t) noexcept { return !it.m_Coroutine || it.m_Coroutine.done(); }
+	};
+
+private:
+	std::coroutine_handle<promise_type> m_Coroutine{ };
+	explicit STREAM(std::coroutine_handle<promise_type> coroutine) noexcept : m_Coroutine{ coroutine } { }
+
+public:
+	STREAM(STREAM&& other) noexcept : m_Coroutine{ std::exchange(other.m_Coroutine, { }) } { }
+	STREAM& operator=(STREAM&& other) noexcept {
+		if (this == &other) { return *this; }
+		if (m_Coroutine) { m_Coroutine.destroy(); }
+		m_Coroutine = std::exchange(other.m_Coroutine, { });
+		return *this;
+	}
+	~STREAM() { if (m_Coroutine) { m_Coroutine.destroy(); } }
+
+	// Starts the coroutine, so begin is called once
+	[[nodiscard]] ITERATOR begin() {
+		m_Coroutine.resume();
+		return ITERATOR{ m_Coroutine };
+	}
+	[[nodiscard]] std::default_sentinel_t end() const noexcept { return { }; }
+};
+
+// Read access to a LIFE_HISTORY from any thread, alongside the owner & other readers
+// Each reader thread needs its own READER, which must not outlive the history
+// Published frames are found without locks (only the handle to the latest frame is copied under a brief lock)
+// Generations between checkpoints are recomputed on the reader's own thread & kept in its own small cache
+class LIFE_HISTORY::READER {
+	static constexpr size_t cacheCapacity{ 16 };
+	const LIFE_HISTORY* m_History{ nullptr };
+	std::map<size_t, FRAME_HANDLE> m_Cache{ };
+public:
+	explicit READER(const LIFE_HISTORY& history) noexcept : m_History{ &history } { }
+
+	// Latest generation published by the owner
+	[[nodiscard]] size_t Generation() const noexcept;
+
+	// Frame of generation #, clamped to the generations on record like LIFE_HISTORY::operator[]
+	[[nodiscard]] FRAME_HANDLE operator[] (size_t generationNumber);
 };
 
 #endif // !CELL_CLASS_H
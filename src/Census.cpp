@@ -0,0 +1,302 @@
+#include "framework.h"
+#include "Census.h"
+using namespace std;
+
+// Cells relative to some origin, signed so that shapes can be turned & moved freely
+using SHAPE_CELLS = vector<pair<int64_t, int64_t>>;
+
+constexpr auto objectReach = 2u;		// Cells this close share a neighbor, so belong to one object
+
+static bool IsAlive(const TIME_SLICE& frame, CELL_POSITION position) noexcept {
+	return (static_cast<uint8_t>(frame.LifeState(position)) & static_cast<uint8_t>(LIFE_STATE::ALIVE)) != 0;
+}
+
+static SHAPE_CELLS ToShape(const vector<CELL_POSITION>& cells) {
+	auto shape = SHAPE_CELLS{ };
+	shape.reserve(cells.size());
+	for (auto cell : cells) { shape.emplace_back(cell.row, cell.column); }
+	return shape;
+}
+
+// Top left corner of the cells' bounding box
+static pair<int64_t, int64_t> ShapeOrigin(const SHAPE_CELLS& shape) noexcept {
+	auto origin = shape.empty() ? pair<int64_t, int64_t>{ } : shape.front();
+	for (const auto& cell : shape) { origin = { min(origin.first, cell.first), min(origin.second, cell.second) }; }
+	return origin;
+}
+
+// Cells moved to the origin, row by row
+static SHAPE_CELLS Normalize(SHAPE_CELLS shape) {
+	auto origin = ShapeOrigin(shape);
+	for (auto& cell : shape) { cell = { cell.first - origin.first, cell.second - origin.second }; }
+	sort(shape.begin(), shape.end());
+	return shape;
+}
+
+static uint64_t CanonicalHash(const SHAPE_CELLS& shape) {
+	auto best = SHAPE_CELLS{ };
+	for (auto orientation = 0u; orientation < 8; ++orientation) {
+		auto turned = shape;
+		for (auto& cell : turned) {
+			if (orientation & 1u) { swap(cell.first, cell.second); }
+			if (orientation & 2u) { cell.first = -cell.first; }
+			if (orientation & 4u) { cell.second = -cell.second; }
+		}
+		turned = Normalize(move(turned));
+		if (orientation == 0 || turned < best) { best = move(turned); }
+	}
+
+	auto hash = uint64_t{ 14695981039346656037ull };
+	auto mix = [&hash](uint64_t value) { hash = (hash ^ value) * 1099511628211ull; };
+	mix(best.size());
+	for (const auto& cell : best) {
+		mix(static_cast<uint64_t>(cell.first));
+		mix(static_cast<uint64_t>(cell.second));
+	}
+	return hash;
+}
+
+// Run a shape on an empty board wide enough that nothing it sends out at light speed reaches the edge
+// Each generation's live cells are passed on relative to the shape's starting origin, until visit returns false
+static void RunIsolated(const SHAPE_CELLS& shape, size_t generations, shared_ptr<THREAD_POOL> pool, const function<bool(const SHAPE_CELLS&, size_t)>& visit) {
+	const auto start = Normalize(shape);
+	const auto margin = static_cast<int64_t>(generations) + 2;
+	auto extent = pair<int64_t, int64_t>{ };
+	for (const auto& cell : start) { extent = { max(extent.first, cell.first + 1), max(extent.second, cell.second + 1) }; }
+	auto history = LIFE_HISTORY{ BOARD_SIZE{ static_cast<unsigned int>(extent.second + 2 * margin), static_cast<unsigned int>(extent.first + 2 * margin) }, move(pool) };
+	auto& frame = history.GetLatestGeneration();
+	for (const auto& cell : start) { frame[CELL_POSITION{ static_cast<unsigned int>(cell.first + margin), static_cast<unsigned int>(cell.second + margin) }].TogleDeadAlive(); }
+
+	auto live = SHAPE_CELLS{ };
+	for (auto generation = size_t{ 1 }; generation <= generations; ++generation) {
+		const auto& next = history.Advance();
+		live.clear();
+		for (auto position : next.Positions()) {
+			if (IsAlive(next, position)) { live.emplace_back(static_cast<int64_t>(position.row) - margin, static_cast<int64_t>(position.column) - margin); }
+		}
+		if (!visit(live, generation)) { return; }
+	}
+}
+
+OBJECT_CLASS OBJECT_CENSUS::ClassifyIsolated(const vector<CELL_POSITION>& cells, size_t periodLimit, shared_ptr<THREAD_POOL> pool) {
+	auto type = OBJECT_CLASS{ };
+	const auto start = Normalize(ToShape(cells));
+	if (start.empty()) { return type; }
+	RunIsolated(start, periodLimit, move(pool), [&](const SHAPE_CELLS& live, size_t generation) {
+		if (live.size() != start.size() || Normalize(live) != start) { return true; }
+		auto origin = ShapeOrigin(live);
+		auto rowShift = static_cast<unsigned int>(origin.first < 0 ? -origin.first : origin.first);
+		auto columnShift = static_cast<unsigned int>(origin.second < 0 ? -origin.second : origin.second);
+		type.period = generation;
+		type.majorShift = max(rowShift, columnShift);
+		type.minorShift = min(rowShift, columnShift);
+		type.kind = type.majorShift > 0 ? OBJECT_KIND::SPACESHIP : generation == 1 ? OBJECT_KIND::STILL_LIFE : OBJECT_KIND::OSCILLATOR;
+		return false;
+	});
+	return type;
+}
+
+uint64_t OBJECT_CENSUS::CanonicalShape(const vector<CELL_POSITION>& cells) {
+	return CanonicalHash(ToShape(cells));
+}
+
+// Every phase of each seed is entered, since any of them may turn up on a board
+const unordered_map<uint64_t, OBJECT_CLASS>& OBJECT_CENSUS::KnownObjects() {
+	static const auto known = [] {
+		const auto seeds = vector<pair<string, vector<string>>>{
+			{ "block", { "OO", "OO" } },
+			{ "beehive", { ".OO.", "O..O", ".OO." } },
+			{ "loaf", { ".OO.", "O..O", ".O.O", "..O." } },
+			{ "boat", { "OO.", "O.O", ".O." } },
+			{ "ship", { "OO.", "O.O", ".OO" } },
+			{ "tub", { ".O.", "O.O", ".O." } },
+			{ "pond", { ".OO.", "O..O", "O..O", ".OO." } },
+			{ "long boat", { "OO..", "O.O.", ".O.O", "..O." } },
+			{ "barge", { ".O..", "O.O.", ".O.O", "..O." } },
+			{ "mango", { ".OO..", "O..O.", ".O..O", "..OO." } },
+			{ "eater 1", { "OO..", "O.O.", "..O.", "..OO" } },
+			{ "blinker", { "OOO" } },
+			{ "toad", { ".OOO", "OOO." } },
+			{ "beacon", { "OO..", "OO..", "..OO", "..OO" } },
+			{ "traffic light", { "....O....", "....O....", "....O....", ".........", "OOO...OOO", ".........", "....O....", "....O....", "....O...." } },
+			{ "pulsar", { "..OOO...OOO..", ".............", "O....O.O....O", "O....O.O....O", "O....O.O....O", "..OOO...OOO..", ".............",
+				"..OOO...OOO..", "O....O.O....O", "O....O.O....O", "O....O.O....O", ".............", "..OOO...OOO.." } },
+			{ "pentadecathlon", { "..O....O..", "OO.OOOO.OO", "..O....O.." } },
+			{ "glider", { ".O.", "..O", "OOO" } },
+			{ "lightweight spaceship", { ".O..O", "O....", "O...O", "OOOO." } },
+			{ "middleweight spaceship", { "...O..", ".O...O", "O.....", "O....O", "OOOOO." } },
+			{ "heavyweight spaceship", { "...OO..", ".O....O", "O......", "O.....O", "OOOOOO." } }
+		};
+
+		auto pool = make_shared<THREAD_POOL>(1);
+		auto table = unordered_map<uint64_t, OBJECT_CLASS>{ };
+		for (const auto& [name, rows] : seeds) {
+			auto cells = vector<CELL_POSITION>{ };
+			for (auto row = 0u; row < rows.size(); ++row) {
+				for (auto column = 0u; column < rows[row].size(); ++column) {
+					if (rows[row][column] == 'O') { cells.emplace_back(row, column); }
+				}
+			}
+			auto type = ClassifyIsolated(cells, 30, pool);
+			type.name = name;
+			table.emplace(CanonicalShape(cells), type);
+			if (type.period > 1) {
+				RunIsolated(ToShape(cells), type.period - 1, pool, [&](const SHAPE_CELLS& live, size_t) { table.emplace(CanonicalHash(live), type); return true; });
+			}
+		}
+		return table;
+	}();
+	return known;
+}
+
+OBJECT_CENSUS::OBJECT_CENSUS(size_t periodLimit) : m_PeriodLimit{ periodLimit }, m_Classes{ KnownObjects() }, m_Pool{ make_shared<THREAD_POOL>(1) } { }
+
+const OBJECT_CLASS& OBJECT_CENSUS::Classify(uint64_t shape, const vector<CELL_POSITION>& cells) {
+	auto found = m_Classes.find(shape);
+	if (found == m_Classes.end()) {
+		if (cells.size() > largestClassified) {
+			static const auto unsettled = OBJECT_CLASS{ };
+			return unsettled;
+		}
+		++m_Stats.shapesClassified;
+		found = m_Classes.emplace(shape, ClassifyIsolated(cells, m_PeriodLimit, m_Pool)).first;
+	}
+	return found->second;
+}
+
+const vector<CENSUS_OBJECT>& OBJECT_CENSUS::Update(const TIME_SLICE& frame) {
+	const auto& pyramid = frame.Pyramid();
+	const auto blocks = pyramid.LevelSize(0);
+	const auto size = frame.Size();
+	const auto fresh = size != m_Size;
+	if (fresh) {
+		m_Size = size;
+		m_BlockPrints.assign(blocks.CellCount(), 0);
+		m_Objects.clear();
+	}
+	m_Stats = CENSUS_STATS{ };
+
+	// Fingerprint the alive flags of each occupied block, leaving empty ones at zero
+	auto changed = vector<bool>(blocks.CellCount(), fresh);
+	auto blockCells = [size](CELL_POSITION block) {
+		auto first = CELL_POSITION{ block.row << POPULATION_PYRAMID::leafShift, block.column << POPULATION_PYRAMID::leafShift };
+		return CELL_REGION{ first, CELL_POSITION{ min(first.row + POPULATION_PYRAMID::leafSide, size.height), min(first.column + POPULATION_PYRAMID::leafSide, size.width) } };
+	};
+	for (auto position : ALL_CELL_POSITIONS{ blocks }) {
+		auto print = uint64_t{ 0 };
+		if (pyramid.Count(0, position) > 0) {
+			print = 14695981039346656037ull;
+			auto region = blockCells(position);
+			for (auto row = region.first.row; row < region.end.row; ++row) {
+				for (auto column = region.first.column; column < region.end.column; ++column) { print = (print ^ (IsAlive(frame, CELL_POSITION{ row, column }) ? 1u : 0u)) * 1099511628211ull; }
+			}
+		}
+		auto& previous = m_BlockPrints[static_cast<size_t>(position.row) * blocks.width + position.column];
+		if (print != previous) {
+			changed[static_cast<size_t>(position.row) * blocks.width + position.column] = true;
+			previous = print;
+		}
+	}
+
+	// Keep objects whose cells & surroundings lie in unchanged blocks
+	// Any cell now within reach of such an object was there last time too, so would already be part of it
+	auto unchanged = [&](CELL_REGION bounds) {
+		auto firstRow = (bounds.first.row - min(bounds.first.row, objectReach)) >> POPULATION_PYRAMID::leafShift;
+		auto lastRow = (min(bounds.end.row + objectReach, size.height) - 1) >> POPULATION_PYRAMID::leafShift;
+		auto firstColumn = (bounds.first.column - min(bounds.first.column, objectReach)) >> POPULATION_PYRAMID::leafShift;
+		auto lastColumn = (min(bounds.end.column + objectReach, size.width) - 1) >> POPULATION_PYRAMID::leafShift;
+		for (auto row = firstRow; row <= lastRow; ++row) {
+			for (auto column = firstColumn; column <= lastColumn; ++column) {
+				if (changed[static_cast<size_t>(row) * blocks.width + column]) { return false; }
+			}
+		}
+		return true;
+	};
+	auto objects = vector<CENSUS_OBJECT>{ };
+	auto reseeds = vector<CELL_POSITION>{ };
+	for (auto& object : m_Objects) {
+		if (unchanged(object.bounds)) { objects.push_back(move(object)); }
+		else { reseeds.insert(reseeds.end(), object.cells.begin(), object.cells.end()); }
+	}
+	m_Stats.kept = objects.size();
+
+	// Gather everything else, starting from cells of the objects dropped above & from the changed blocks
+	auto visited = unordered_set<uint64_t>{ };
+	auto visit = [&visited](CELL_POSITION position) { return visited.insert(static_cast<uint64_t>(position.row) << 32 | position.column).second; };
+	auto gather = [&](CELL_POSITION seed) {
+		if (!IsAlive(frame, seed) || !visit(seed)) { return; }
+		auto object = CENSUS_OBJECT{ };
+		auto pending = vector<CELL_POSITION>{ seed };
+		while (!pending.empty()) {
+			auto cell = pending.back();
+			pending.pop_back();
+			object.cells.push_back(cell);
+			auto lastRow = min(cell.row + objectReach, size.height - 1);
+			auto lastColumn = min(cell.column + objectReach, size.width - 1);
+			for (auto row = cell.row - min(cell.row, objectReach); row <= lastRow; ++row) {
+				for (auto column = cell.column - min(cell.column, objectReach); column <= lastColumn; ++column) {
+					auto neighbor = CELL_POSITION{ row, column };
+					if (IsAlive(frame, neighbor) && visit(neighbor)) { pending.push_back(neighbor); }
+				}
+			}
+		}
+		sort(object.cells.begin(), object.cells.end(), [](CELL_POSITION a, CELL_POSITION b) { return a.row != b.row ? a.row < b.row : a.column < b.column; });
+		object.bounds = CELL_REGION{ object.cells.front(), CELL_POSITION{ object.cells.back().row + 1, object.cells.front().column + 1 } };
+		for (auto cell : object.cells) {
+			object.bounds.first.column = min(object.bounds.first.column, cell.column);
+			object.bounds.end.column = max(object.bounds.end.column, cell.column + 1);
+		}
+		object.shape = CanonicalShape(object.cells);
+		object.type = Classify(object.shape, object.cells);
+		objects.push_back(move(object));
+		++m_Stats.found;
+	};
+	for (auto cell : reseeds) { gather(cell); }
+	for (auto position : ALL_CELL_POSITIONS{ blocks }) {
+		if (!changed[static_cast<size_t>(position.row) * blocks.width + position.column] || pyramid.Count(0, position) == 0) { continue; }
+		++m_Stats.blocksRescanned;
+		auto region = blockCells(position);
+		for (auto row = region.first.row; row < region.end.row; ++row) {
+			for (auto column = region.first.column; column < region.end.column; ++column) { gather(CELL_POSITION{ row, column }); }
+		}
+	}
+
+	// By first cell, which no two objects share
+	sort(objects.begin(), objects.end(), [](const CENSUS_OBJECT& a, const CENSUS_OBJECT& b) {
+		return a.cells.front().row != b.cells.front().row ? a.cells.front().row < b.cells.front().row : a.cells.front().column < b.cells.front().column;
+	});
+	m_Objects = move(objects);
+	return m_Objects;
+}
+
+map<string, size_t> OBJECT_CENSUS::Tally() const {
+	auto tally = map<string, size_t>{ };
+	for (const auto& object : m_Objects) { ++tally[Label(object)]; }
+	return tally;
+}
+
+string OBJECT_CENSUS::Label(const CENSUS_OBJECT& object) {
+	const auto& type = object.type;
+	if (!type.name.empty()) { return type.name; }
+
+	auto label = string{ };
+	switch (type.kind) {
+	case OBJECT_KIND::UNSETTLED:
+		return "unsettled";
+	case OBJECT_KIND::STILL_LIFE:
+		label = "still life";
+		break;
+	case OBJECT_KIND::OSCILLATOR:
+		label = "p" + to_string(type.period) + " oscillator";
+		break;
+	case OBJECT_KIND::SPACESHIP:
+		label = (type.majorShift > 1 ? to_string(type.majorShift) : string{ }) + "c/" + to_string(type.period)
+			+ (type.minorShift == 0 ? " orthogonal" : type.minorShift == type.majorShift ? " diagonal" : " oblique") + " spaceship";
+		break;
+	}
+
+	constexpr auto digits = "0123456789abcdef";
+	label += " (" + to_string(object.cells.size()) + " cells) #";
+	for (auto shift = 60; shift >= 0; shift -= 4) { label += digits[(object.shape >> shift) & 0xf]; }
+	return label;
+}
@@ -0,0 +1,84 @@
+#ifndef OBJECT_CENSUS_CLASS_H
+#define OBJECT_CENSUS_CLASS_H
+#include "framework.h"
+#include "CELL.h"
+
+enum class OBJECT_KIND {
+	UNSETTLED = 0,		// Did not repeat within the period limit
+	STILL_LIFE = 1,
+	OSCILLATOR = 2,
+	SPACESHIP = 3
+};
+
+// What an object does when left on its own, the same in every orientation
+struct OBJECT_CLASS {
+	OBJECT_KIND kind{ OBJECT_KIND::UNSETTLED };
+	size_t period{ 0 };
+	unsigned int majorShift{ 0 };		// Spaceships only, cells moved per period along the faster axis
+	unsigned int minorShift{ 0 };		// & along the slower one
+	std::string name{ };				// Empty unless the shape is in the known object table
+};
+
+struct CENSUS_OBJECT {
+	CELL_REGION bounds{ };
+	std::vector<CELL_POSITION> cells{ };	// Row by row
+	std::uint64_t shape{ 0 };				// Equal for the same cells under any rotation, reflection or translation
+	OBJECT_CLASS type{ };
+};
+
+struct CENSUS_STATS {
+	size_t kept{ 0 };				// Objects carried over from the last update without a rescan
+	size_t found{ 0 };				// Objects gathered anew
+	size_t blocksRescanned{ 0 };	// Occupied leaf blocks that changed since the last update
+	size_t shapesClassified{ 0 };	// Shapes simulated for the first time
+};
+
+// OBJECT_CENSUS lists the objects on a board: live cells are grouped, each group's shape is canonicalised & then classified
+// Cells within two of each other share a neighbor & so cannot evolve apart, which makes them one object
+// (Like other soup searches this joins objects that merely sit close, e.g. a beacon is one object in every phase)
+// A shape seen for the first time is simulated in isolation to find its period & motion, then named from the known object table
+//
+// Updates are incremental: each occupied leaf block of the frame's POPULATION_PYRAMID is fingerprinted
+// An object whose surroundings are all in unchanged blocks is kept as it was, so a settled board is mostly not regrouped
+// Empty blocks are skipped outright using the pyramid's counts
+class OBJECT_CENSUS {
+	// Bigger groups, typically the unsettled mass of a young soup, are reported UNSETTLED without simulating them
+	static constexpr size_t largestClassified{ 1024 };		// cells
+
+	size_t m_PeriodLimit{ 30 };
+	BOARD_SIZE m_Size{ 0, 0 };
+	std::vector<std::uint64_t> m_BlockPrints{ };	// Per leaf block, as of the last update
+	std::vector<CENSUS_OBJECT> m_Objects{ };
+	std::unordered_map<std::uint64_t, OBJECT_CLASS> m_Classes{ };	// By shape, every shape classified so far
+	std::shared_ptr<THREAD_POOL> m_Pool{ };			// Isolated simulations are too small to be worth splitting
+	CENSUS_STATS m_Stats{ };
+
+	[[nodiscard]] const OBJECT_CLASS& Classify(std::uint64_t shape, const std::vector<CELL_POSITION>& cells);
+
+public:
+	// Shapes that have not repeated within periodLimit generations are reported UNSETTLED
+	explicit OBJECT_CENSUS(size_t periodLimit = 30);
+
+	// Bring the census up to date with a frame, typically a later generation of the one last passed
+	const std::vector<CENSUS_OBJECT>& Update(const TIME_SLICE& frame);
+
+	[[nodiscard]] const std::vector<CENSUS_OBJECT>& Objects() const noexcept { return m_Objects; }
+	[[nodiscard]] CENSUS_STATS Stats() const noexcept { return m_Stats; }
+
+	// Number of objects of each kind, by Label
+	[[nodiscard]] std::map<std::string, size_t> Tally() const;
+
+	// Known name, or the kind & period followed by the shape in hex
+	[[nodiscard]] static std::string Label(const CENSUS_OBJECT& object);
+
+	// Hash of the cells after translating them to the origin & picking the least of their 8 orientations
+	[[nodiscard]] static std::uint64_t CanonicalShape(const std::vector<CELL_POSITION>& cells);
+
+	// Simulate the cells on an otherwise empty board until they repeat (up to a translation) or the limit runs out
+	[[nodiscard]] static OBJECT_CLASS ClassifyIsolated(const std::vector<CELL_POSITION>& cells, size_t periodLimit, std::shared_ptr<THREAD_POOL> pool);
+
+	// Shapes of every phase of some common objects, by CanonicalShape
+	[[nodiscard]] static const std::unordered_map<std::uint64_t, OBJECT_CLASS>& KnownObjects();
+};
+
+#endif // !OBJECT_CENSUS_CLASS_H
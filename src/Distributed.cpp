@@ -0,0 +1,332 @@
+#include "framework.h"
+#include "Distributed.h"
+#ifndef _WIN32
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif // !_WIN32
+using namespace std;
+
+template<class T>
+static void SendValue(HALO_LINK& link, const T& value) {
+	static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can cross a link as raw bytes.");
+	link.Send(&value, sizeof(T));
+}
+
+template<class T>
+[[nodiscard]] static T ReceiveValue(HALO_LINK& link) {
+	static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can cross a link as raw bytes.");
+	auto value = T{ };
+	link.Receive(&value, sizeof(T));
+	return value;
+}
+
+static double SecondsSince(std::chrono::steady_clock::time_point start) noexcept {
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+#ifndef _WIN32
+UNIX_SOCKET_LINK::~UNIX_SOCKET_LINK() {
+	if (m_Socket >= 0) { ::close(m_Socket); }
+}
+
+std::pair<std::unique_ptr<UNIX_SOCKET_LINK>, std::unique_ptr<UNIX_SOCKET_LINK>> UNIX_SOCKET_LINK::Pair() {
+	int sockets[2]{ -1, -1 };
+	if (::socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0) { throw std::runtime_error{ std::string{ "Unable to create socket pair: " } + std::strerror(errno) }; }
+	return { std::make_unique<UNIX_SOCKET_LINK>(sockets[0]), std::make_unique<UNIX_SOCKET_LINK>(sockets[1]) };
+}
+
+void UNIX_SOCKET_LINK::Send(const void* data, size_t size) {
+	const auto* bytes = static_cast<const char*>(data);
+	while (size > 0) {
+		auto sent = ::send(m_Socket, bytes, size, MSG_NOSIGNAL);
+		if (sent < 0 && errno == EINTR) { continue; }
+		if (sent <= 0) { throw std::runtime_error{ std::string{ "Halo link send failed: " } + std::strerror(errno) }; }
+		bytes += sent;
+		size -= static_cast<size_t>(sent);
+	}
+}
+
+void UNIX_SOCKET_LINK::Receive(void* data, size_t size) {
+	auto* bytes = static_cast<char*>(data);
+	while (size > 0) {
+		auto received = ::recv(m_Socket, bytes, size, 0);
+		if (received < 0 && errno == EINTR) { continue; }
+		if (received == 0) { throw std::runtime_error{ "Halo link closed by peer." }; }
+		if (received < 0) { throw std::runtime_error{ std::string{ "Halo link receive failed: " } + std::strerror(errno) }; }
+		bytes += received;
+		size -= static_cast<size_t>(received);
+	}
+}
+#endif // !_WIN32
+
+STRIP_WORKER::STRIP_WORKER(std::unique_ptr<HALO_LINK> coordinator, std::unique_ptr<HALO_LINK> above, std::unique_ptr<HALO_LINK> below) noexcept
+	: m_Coordinator{ std::move(coordinator) }, m_Above{ std::move(above) }, m_Below{ std::move(below) } { }
+
+// Cell at column 0 of a loaded row, with the padding column just before it
+STRIP_WORKER::CELL* STRIP_WORKER::Row(size_t buffer, unsigned int boardRow) noexcept {
+	return m_Buffers[buffer].data() + (static_cast<std::ptrdiff_t>(boardRow - m_LoadedFirstRow) + 1) * Stride() + 1;
+}
+
+void STRIP_WORKER::Run() {
+	Load();
+	while (true) {
+		auto command = ReceiveValue<STRIP_COMMAND>(*m_Coordinator);
+		auto argument = ReceiveValue<std::uint64_t>(*m_Coordinator);
+		switch (command) {
+		case STRIP_COMMAND::ADVANCE:
+			AdvanceGenerations(static_cast<size_t>(argument));
+			SendValue(*m_Coordinator, Stats());
+			break;
+		case STRIP_COMMAND::STATS:
+			SendValue(*m_Coordinator, Stats());
+			break;
+		case STRIP_COMMAND::GATHER:
+			for (auto row = m_Strip.firstRow; row < m_Strip.endRow; ++row) { m_Coordinator->Send(Row(m_Current, row), m_Strip.width); }
+			break;
+		case STRIP_COMMAND::STOP:
+			return;
+		default:
+			throw std::runtime_error{ "Unknown strip command." };
+		}
+	}
+}
+
+// Receive the geometry & the life state of every cell in the strip
+// Neighbor counts & predictions are then computed as though each living cell had been toggled on
+void STRIP_WORKER::Load() {
+	m_Strip = ReceiveValue<STRIP_GEOMETRY>(*m_Coordinator);
+	const auto halo = m_Strip.haloDepth;
+	if (halo == 0 || m_Strip.firstRow >= m_Strip.endRow || m_Strip.endRow > m_Strip.height || m_Strip.endRow - m_Strip.firstRow < halo) {
+		throw std::runtime_error{ "Strip geometry is invalid." };
+	}
+	if ((m_Strip.firstRow > 0) != static_cast<bool>(m_Above) || (m_Strip.endRow < m_Strip.height) != static_cast<bool>(m_Below)) {
+		throw std::runtime_error{ "Strip neighbors do not match its geometry." };
+	}
+	m_LoadedFirstRow = m_Strip.firstRow - (m_Above ? halo : 0u);
+	m_LoadedEndRow = m_Strip.endRow + (m_Below ? halo : 0u);
+	for (auto& buffer : m_Buffers) { buffer.assign(static_cast<size_t>(Stride()) * (m_LoadedEndRow - m_LoadedFirstRow + 2), CELL{ }); }
+
+	for (auto row = m_Strip.firstRow; row < m_Strip.endRow; ++row) {
+		auto* cells = Row(m_Current, row);
+		m_Coordinator->Receive(cells, m_Strip.width);
+		for (auto column = 0u; column < m_Strip.width; ++column) { cells[column].bits &= CELL::stateMask; }
+	}
+	ExchangeHalo();
+
+	const auto stride = Stride();
+	const auto neighborOffsets = std::array<std::ptrdiff_t, 8>{ -stride - 1, -stride, -stride + 1, -1, 1, stride - 1, stride, stride + 1 };
+	for (auto row = m_Strip.firstRow; row < m_Strip.endRow; ++row) {
+		auto* cells = Row(m_Current, row);
+		for (auto column = 0u; column < m_Strip.width; ++column) {
+			auto count = 0u;
+			for (auto offset : neighborOffsets) { count += (cells[column + offset].bits & static_cast<std::uint8_t>(LIFE_STATE::ALIVE)) ? 1u : 0u; }
+			cells[column].bits = lifePredictionTable[cells[column].bits | (count << CELL::countShift)];
+		}
+	}
+}
+
+// Trade the outermost haloDepth rows of the strip for the same number of rows from each neighbor
+// Both sends run alongside the receives, so large halos cannot fill the links & deadlock
+void STRIP_WORKER::ExchangeHalo() {
+	auto start = std::chrono::steady_clock::now();
+	const auto halo = m_Strip.haloDepth;
+	const auto bytes = static_cast<size_t>(Stride()) * halo * sizeof(CELL);
+	auto sending = std::async(std::launch::async, [&] {
+		if (m_Above) { m_Above->Send(Row(m_Current, m_Strip.firstRow) - 1, bytes); }
+		if (m_Below) { m_Below->Send(Row(m_Current, m_Strip.endRow - halo) - 1, bytes); }
+	});
+	try {
+		if (m_Above) { m_Above->Receive(Row(m_Current, m_Strip.firstRow - halo) - 1, bytes); }
+		if (m_Below) { m_Below->Receive(Row(m_Current, m_Strip.endRow) - 1, bytes); }
+	}
+	catch (...) { sending.wait(); throw; }
+	sending.get();
+
+	m_Stats.haloBytes += bytes * ((m_Above ? 1 : 0) + (m_Below ? 1 : 0));
+	++m_Stats.exchanges;
+	m_Stats.exchangeSeconds += SecondsSince(start);
+}
+
+// Halo rows next to a neighbor go stale one row per generation, so the swept rows shrink to match
+// Rows on the edge of the board are exact, since everything beyond stays dead
+void STRIP_WORKER::AdvanceGenerations(size_t generations) {
+	const auto loadedHeight = m_LoadedEndRow - m_LoadedFirstRow;
+	const auto shrinkTop = m_Above ? 1u : 0u;
+	const auto shrinkBottom = m_Below ? 1u : 0u;
+	while (generations > 0) {
+		auto depth = static_cast<unsigned int>(std::min<size_t>(generations, m_Strip.haloDepth));
+		ExchangeHalo();
+
+		auto start = std::chrono::steady_clock::now();
+		for (auto step = 1u; step <= depth; ++step) {
+			auto region = CELL_REGION{ CELL_POSITION{ shrinkTop * step, 0u }, CELL_POSITION{ loadedHeight - shrinkBottom * step, m_Strip.width } };
+			auto next = 1 - m_Current;
+			TIME_SLICE::SweepRegion(Row(m_Current, m_LoadedFirstRow), Row(next, m_LoadedFirstRow), Stride(), region, m_Scratch);
+			m_Current = next;
+		}
+		m_Stats.computeSeconds += SecondsSince(start);
+		m_Stats.generation += depth;
+		generations -= depth;
+	}
+}
+
+STRIP_STATS STRIP_WORKER::Stats() noexcept {
+	m_Stats.population = 0;
+	for (auto row = m_Strip.firstRow; row < m_Strip.endRow; ++row) {
+		const auto* cells = Row(m_Current, row);
+		for (auto column = 0u; column < m_Strip.width; ++column) { m_Stats.population += (cells[column].bits & static_cast<std::uint8_t>(LIFE_STATE::ALIVE)) ? 1u : 0u; }
+	}
+	return m_Stats;
+}
+
+STRIP_COORDINATOR::STRIP_COORDINATOR(std::vector<std::unique_ptr<HALO_LINK>> workers, std::vector<STRIP_GEOMETRY> strips)
+	: m_Workers{ std::move(workers) }, m_Strips{ std::move(strips) } {
+	if (m_Workers.size() != m_Strips.size()) { throw std::invalid_argument{ "Every strip needs exactly one worker." }; }
+	for (auto i = size_t{ 0 }; i < m_Workers.size(); ++i) { SendValue(*m_Workers[i], m_Strips[i]); }
+}
+
+// Stopped workers exit on their own; any that already failed simply have nothing left to read
+STRIP_COORDINATOR::~STRIP_COORDINATOR() {
+	for (auto i = size_t{ 0 }; i < m_Workers.size(); ++i) {
+		try { Command(i, STRIP_COMMAND::STOP, 0); }
+		catch (const std::exception&) { }
+	}
+	m_Workers.clear();
+#ifndef _WIN32
+	for (auto process : m_Processes) { ::waitpid(process, nullptr, 0); }
+#endif // !_WIN32
+}
+
+std::vector<STRIP_GEOMETRY> STRIP_COORDINATOR::Partition(unsigned int width, unsigned int height, size_t workerCount, unsigned int haloDepth) {
+	if (width == 0 || height == 0 || workerCount == 0 || haloDepth == 0) { throw std::invalid_argument{ "Board size, worker count, and halo depth must all be positive." }; }
+	auto strips = std::vector<STRIP_GEOMETRY>{ };
+	for (auto i = size_t{ 0 }; i < workerCount; ++i) {
+		auto firstRow = static_cast<std::uint32_t>(height * i / workerCount);
+		auto endRow = static_cast<std::uint32_t>(height * (i + 1) / workerCount);
+		if (endRow - firstRow < haloDepth) { throw std::invalid_argument{ "Strips must be at least as tall as the halo depth." }; }
+		strips.push_back(STRIP_GEOMETRY{ width, height, firstRow, endRow, haloDepth });
+	}
+	return strips;
+}
+
+#ifndef _WIN32
+STRIP_COORDINATOR STRIP_COORDINATOR::SpawnLocalWorkers(std::vector<STRIP_GEOMETRY> strips) {
+	const auto count = strips.size();
+	auto controlLinks = std::vector<std::pair<std::unique_ptr<UNIX_SOCKET_LINK>, std::unique_ptr<UNIX_SOCKET_LINK>>>{ };
+	auto neighborLinks = decltype(controlLinks){ };		// Entry i joins worker i (first) to worker i + 1 (second)
+	for (auto i = size_t{ 0 }; i < count; ++i) { controlLinks.push_back(UNIX_SOCKET_LINK::Pair()); }
+	for (auto i = size_t{ 1 }; i < count; ++i) { neighborLinks.push_back(UNIX_SOCKET_LINK::Pair()); }
+
+	auto processes = std::vector<int>{ };
+	for (auto i = size_t{ 0 }; i < count; ++i) {
+		auto process = ::fork();
+		if (process < 0) { throw std::runtime_error{ std::string{ "Unable to start worker process: " } + std::strerror(errno) }; }
+		if (process == 0) {
+			// Keep this worker's three ends and close everything else, so a dead peer is seen as a closed link
+			auto worker = STRIP_WORKER{
+				std::move(controlLinks[i].second),
+				i > 0 ? std::move(neighborLinks[i - 1].second) : nullptr,
+				i + 1 < count ? std::move(neighborLinks[i].first) : nullptr
+			};
+			controlLinks.clear();
+			neighborLinks.clear();
+			auto status = 0;
+			try { worker.Run(); }
+			catch (const std::exception&) { status = 2; }
+			::_exit(status);
+		}
+		processes.push_back(process);
+	}
+
+	auto workers = std::vector<std::unique_ptr<HALO_LINK>>{ };
+	for (auto& link : controlLinks) { workers.push_back(std::move(link.first)); }
+	controlLinks.clear();
+	neighborLinks.clear();
+	auto coordinator = STRIP_COORDINATOR{ std::move(workers), std::move(strips) };
+	coordinator.m_Processes = std::move(processes);
+	return coordinator;
+}
+#endif // !_WIN32
+
+void STRIP_COORDINATOR::Command(size_t worker, STRIP_COMMAND command, std::uint64_t argument) {
+	SendValue(*m_Workers[worker], command);
+	SendValue(*m_Workers[worker], argument);
+}
+
+std::vector<STRIP_STATS> STRIP_COORDINATOR::ReceiveStats() {
+	auto stats = std::vector<STRIP_STATS>{ };
+	for (auto& worker : m_Workers) { stats.push_back(ReceiveValue<STRIP_STATS>(*worker)); }
+	return stats;
+}
+
+void STRIP_COORDINATOR::Scatter(const std::function<bool(CELL_POSITION)>& isAlive) {
+	auto states = std::vector<std::uint8_t>{ };
+	for (auto i = size_t{ 0 }; i < m_Workers.size(); ++i) {
+		const auto& strip = m_Strips[i];
+		states.resize(strip.width);
+		for (auto row = strip.firstRow; row < strip.endRow; ++row) {
+			for (auto column = 0u; column < strip.width; ++column) {
+				states[column] = static_cast<std::uint8_t>(isAlive(CELL_POSITION{ row, column }) ? LIFE_STATE::ALIVE : LIFE_STATE::STABLE_DEAD);
+			}
+			m_Workers[i]->Send(states.data(), states.size());
+		}
+	}
+}
+
+// Every worker is told before any reply is awaited, so the strips advance concurrently
+std::vector<STRIP_STATS> STRIP_COORDINATOR::Advance(size_t generations) {
+	for (auto i = size_t{ 0 }; i < m_Workers.size(); ++i) { Command(i, STRIP_COMMAND::ADVANCE, generations); }
+	m_Generation += generations;
+	return ReceiveStats();
+}
+
+std::vector<STRIP_STATS> STRIP_COORDINATOR::Stats() {
+	for (auto i = size_t{ 0 }; i < m_Workers.size(); ++i) { Command(i, STRIP_COMMAND::STATS, 0); }
+	return ReceiveStats();
+}
+
+void STRIP_COORDINATOR::Gather(const std::function<void(unsigned int row, const std::uint8_t* cells)>& visitRow) {
+	auto cells = std::vector<std::uint8_t>{ };
+	for (auto i = size_t{ 0 }; i < m_Workers.size(); ++i) {
+		const auto& strip = m_Strips[i];
+		cells.resize(strip.width);
+		Command(i, STRIP_COMMAND::GATHER, 0);
+		for (auto row = strip.firstRow; row < strip.endRow; ++row) {
+			m_Workers[i]->Receive(cells.data(), cells.size());
+			visitRow(row, cells.data());
+		}
+	}
+}
+
+// Padding cells are dead & hash as zero bytes, exactly as they sit in a TIME_SLICE layout
+std::uint64_t STRIP_COORDINATOR::Hash() {
+	auto hash = std::uint64_t{ 14695981039346656037ull };
+	auto hashByte = [&hash](std::uint8_t byte) { hash = (hash ^ byte) * 1099511628211ull; };
+	auto hashPaddingRow = [&] { for (auto column = 0u; column < m_Strips.front().width + 2; ++column) { hashByte(0); } };
+	hashPaddingRow();
+	Gather([&](unsigned int, const std::uint8_t* cells) {
+		hashByte(0);
+		for (auto column = 0u; column < m_Strips.front().width; ++column) { hashByte(cells[column]); }
+		hashByte(0);
+	});
+	hashPaddingRow();
+	return hash;
+}
+
+void STRIP_COORDINATOR::Save(std::ostream& stream) {
+	const auto width = m_Strips.front().width;
+	const auto padding = std::vector<char>(width + 2, 0);
+	LIFE_HISTORY::SaveHeader(stream, width, m_Strips.front().height, m_Generation, 1);
+	LIFE_HISTORY::SaveFrameHeader(stream, m_Generation, TIME_SLICE::STATUS::GENERATED);
+	stream.write(padding.data(), padding.size());
+	Gather([&](unsigned int, const std::uint8_t* cells) {
+		stream.put(0);
+		stream.write(reinterpret_cast<const char*>(cells), width);
+		stream.put(0);
+	});
+	stream.write(padding.data(), padding.size());
+	if (!stream) { throw std::runtime_error{ "Failed to write distributed board snapshot." }; }
+}
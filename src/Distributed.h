@@ -0,0 +1,146 @@
+#ifndef DISTRIBUTED_CLASS_H
+#define DISTRIBUTED_CLASS_H
+#include "framework.h"
+#include "CELL.h"
+
+// Distributed mode splits one board into horizontal strips, each owned by a separate worker process
+// A board too large for one LIFE_HISTORY (or one host) then only needs a single strip in memory per worker
+//
+// Every worker also holds haloDepth rows of each neighboring strip, refreshed by a halo exchange
+// After an exchange a worker advances up to haloDepth generations on its own, like a temporally blocked tile
+// Each generation one more halo row goes stale, so after haloDepth generations exactly the strip itself remains valid
+// A STRIP_COORDINATOR hands out the strips, drives the workers, and gathers statistics & snapshots
+
+// Ordered byte stream between two processes, the pluggable transport beneath halo exchange & coordination
+// Receive blocks until every requested byte has arrived
+// Implementations throw std::runtime_error once the other end is gone
+class HALO_LINK {
+public:
+	virtual ~HALO_LINK() = default;
+	virtual void Send(const void* data, size_t size) = 0;
+	virtual void Receive(void* data, size_t size) = 0;
+};
+
+#ifndef _WIN32
+// Reference transport over a connected Unix domain socket
+class UNIX_SOCKET_LINK final : public HALO_LINK {
+	int m_Socket{ -1 };
+public:
+	explicit UNIX_SOCKET_LINK(int socket) noexcept : m_Socket{ socket } { }
+	UNIX_SOCKET_LINK(const UNIX_SOCKET_LINK&) = delete;
+	UNIX_SOCKET_LINK& operator=(const UNIX_SOCKET_LINK&) = delete;
+	~UNIX_SOCKET_LINK() override;
+
+	// Both ends of a new connection, to be shared with a child process through fork()
+	[[nodiscard]] static std::pair<std::unique_ptr<UNIX_SOCKET_LINK>, std::unique_ptr<UNIX_SOCKET_LINK>> Pair();
+
+	void Send(const void* data, size_t size) override;
+	void Receive(void* data, size_t size) override;
+};
+#endif // !_WIN32
+
+// Rows of the whole board owned by one worker, from firstRow up to, but not including, endRow
+// Raw structs cross the links in native byte order, so coordinator & workers must share a build
+struct STRIP_GEOMETRY {
+	std::uint32_t width{ 0 };			// Whole board
+	std::uint32_t height{ 0 };
+	std::uint32_t firstRow{ 0 };
+	std::uint32_t endRow{ 0 };
+	std::uint32_t haloDepth{ 1 };		// Rows borrowed from each neighbor, and generations per exchange
+};
+
+struct STRIP_STATS {
+	std::uint64_t generation{ 0 };
+	std::uint64_t population{ 0 };		// Living cells within the strip
+	std::uint64_t exchanges{ 0 };
+	std::uint64_t haloBytes{ 0 };		// Sent to neighbors
+	double computeSeconds{ 0.0 };
+	double exchangeSeconds{ 0.0 };		// Includes waiting on slower neighbors
+};
+
+// Requests from the coordinator, each followed by a 64-bit argument
+enum class STRIP_COMMAND : std::uint8_t {
+	ADVANCE = 1,		// Advance # generations, reply with STRIP_STATS
+	STATS = 2,			// Reply with STRIP_STATS
+	GATHER = 3,			// Reply with every row of the strip
+	STOP = 4
+};
+
+// One strip of the board, served to a coordinator until it says STOP
+// The strip is stored padded with dead cells & laid out like a TIME_SLICE, so the sweep kernel applies unchanged
+class STRIP_WORKER {
+	using CELL = TIME_SLICE::CELL;
+
+	std::unique_ptr<HALO_LINK> m_Coordinator;
+	std::unique_ptr<HALO_LINK> m_Above;			// Worker owning the strip above, if any
+	std::unique_ptr<HALO_LINK> m_Below;			// Worker owning the strip below, if any
+	STRIP_GEOMETRY m_Strip{ };
+	unsigned int m_LoadedFirstRow{ 0 };			// Strip plus halo
+	unsigned int m_LoadedEndRow{ 0 };
+	std::array<std::vector<CELL>, 2> m_Buffers{ };
+	size_t m_Current{ 0 };						// Buffer holding the latest generation
+	std::vector<std::uint8_t> m_Scratch{ };
+	STRIP_STATS m_Stats{ };
+
+public:
+	STRIP_WORKER(std::unique_ptr<HALO_LINK> coordinator, std::unique_ptr<HALO_LINK> above, std::unique_ptr<HALO_LINK> below) noexcept;
+
+	// Receive the strip, then answer commands until STOP
+	// Throws std::runtime_error if a link fails or the strip does not fit its neighbors
+	void Run();
+
+private:
+	[[nodiscard]] std::ptrdiff_t Stride() const noexcept { return static_cast<std::ptrdiff_t>(m_Strip.width) + 2; }
+	[[nodiscard]] CELL* Row(size_t buffer, unsigned int boardRow) noexcept;
+	void Load();
+	void ExchangeHalo();
+	void AdvanceGenerations(size_t generations);
+	[[nodiscard]] STRIP_STATS Stats() noexcept;
+};
+
+// Drives a set of strip workers as one board
+// Workers must be connected to their neighbors in the order of their strips
+class STRIP_COORDINATOR {
+	std::vector<std::unique_ptr<HALO_LINK>> m_Workers{ };
+	std::vector<STRIP_GEOMETRY> m_Strips{ };
+	size_t m_Generation{ 0 };
+	std::vector<int> m_Processes{ };			// Process ids of locally spawned workers, reaped on destruction
+
+	void Command(size_t worker, STRIP_COMMAND command, std::uint64_t argument);
+	[[nodiscard]] std::vector<STRIP_STATS> ReceiveStats();
+
+public:
+	// Sends each worker its geometry
+	STRIP_COORDINATOR(std::vector<std::unique_ptr<HALO_LINK>> workers, std::vector<STRIP_GEOMETRY> strips);
+	STRIP_COORDINATOR(STRIP_COORDINATOR&&) = default;
+	STRIP_COORDINATOR& operator=(STRIP_COORDINATOR&&) = delete;
+	~STRIP_COORDINATOR();
+
+	// Split a board into strips of near-equal height
+	// Throws std::invalid_argument if any strip would be shorter than the halo it lends its neighbors
+	[[nodiscard]] static std::vector<STRIP_GEOMETRY> Partition(unsigned int width, unsigned int height, size_t workerCount, unsigned int haloDepth);
+
+#ifndef _WIN32
+	// Fork one worker process per strip, connected by Unix domain socket pairs
+	[[nodiscard]] static STRIP_COORDINATOR SpawnLocalWorkers(std::vector<STRIP_GEOMETRY> strips);
+#endif // !_WIN32
+
+	// Initial board, streamed one row at a time so the coordinator never holds the whole board
+	// Must be called once, before any other request
+	void Scatter(const std::function<bool(CELL_POSITION)>& isAlive);
+
+	std::vector<STRIP_STATS> Advance(size_t generations);
+	[[nodiscard]] std::vector<STRIP_STATS> Stats();
+	[[nodiscard]] size_t Generation() const noexcept { return m_Generation; }
+
+	// Visit every row of the board in order, each as raw packed cells
+	void Gather(const std::function<void(unsigned int row, const std::uint8_t* cells)>& visitRow);
+
+	// Same value as TIME_SLICE::Hash() of an equal board
+	[[nodiscard]] std::uint64_t Hash();
+
+	// Life history snapshot of the latest generation, in the LIFE_HISTORY::Save format
+	void Save(std::ostream& stream);
+};
+
+#endif // !DISTRIBUTED_CLASS_H
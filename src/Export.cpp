@@ -0,0 +1,392 @@
+#include "framework.h"
+#include "Export.h"
+#include "Utilities.h"
+using namespace std;
+using namespace RYANS_UTILITIES;
+
+// Bits packed least significant first, the order used by both deflate & GIF's LZW
+class BIT_WRITER {
+	vector<uint8_t>& m_Bytes;
+	uint32_t m_Buffer{ 0 };
+	unsigned int m_Count{ 0 };
+public:
+	explicit BIT_WRITER(vector<uint8_t>& bytes) noexcept : m_Bytes{ bytes } { }
+
+	void Write(uint32_t value, unsigned int bits) {
+		m_Buffer |= value << m_Count;
+		m_Count += bits;
+		while (m_Count >= 8) {
+			m_Bytes.push_back(static_cast<uint8_t>(m_Buffer));
+			m_Buffer >>= 8;
+			m_Count -= 8;
+		}
+	}
+
+	// Huffman codes are defined most significant bit first
+	void WriteReversed(uint32_t code, unsigned int bits) {
+		auto reversed = 0u;
+		for (auto i = 0u; i < bits; ++i) { reversed |= ((code >> i) & 1u) << (bits - 1 - i); }
+		Write(reversed, bits);
+	}
+
+	void Flush() {
+		if (m_Count > 0) { m_Bytes.push_back(static_cast<uint8_t>(m_Buffer)); }
+		m_Buffer = 0;
+		m_Count = 0;
+	}
+};
+
+// Palette index (the LIFE_STATE value) of every pixel, row by row
+// Each row is preceded by "rowPrefix" bytes of zero, as PNG expects a filter type before each row
+static vector<uint8_t> PixelRows(const TIME_SLICE& frame, unsigned int scale, size_t rowPrefix) {
+	auto size = frame.Size();
+	auto rowBytes = rowPrefix + static_cast<size_t>(size.width) * scale;
+	auto pixels = vector<uint8_t>(rowBytes * size.height * scale);
+	for (auto row = 0u; row < size.height; ++row) {
+		auto* first = pixels.data() + static_cast<size_t>(row) * scale * rowBytes;
+		auto* pixel = first + rowPrefix;
+		for (auto column = 0u; column < size.width; ++column) {
+			pixel = fill_n(pixel, scale, static_cast<uint8_t>(frame.LifeState(CELL_POSITION{ row, column })));
+		}
+		for (auto copy = 1u; copy < scale; ++copy) { std::copy(first, first + rowBytes, first + copy * rowBytes); }
+	}
+	return pixels;
+}
+
+// Deflate with the fixed Huffman codes of RFC 1951
+// Scaled boards are runs of repeated pixels & repeated rows, so only two match distances are tried: 1 & one row back
+static void Deflate(const vector<uint8_t>& data, size_t rowBytes, vector<uint8_t>& output) {
+	static constexpr auto lengthBase = array<uint16_t, 29>{ 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+	static constexpr auto lengthExtra = array<uint8_t, 29>{ 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+	static constexpr auto distanceBase = array<uint16_t, 30>{ 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+	static constexpr auto distanceExtra = array<uint8_t, 30>{ 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+	static constexpr auto maxMatch = size_t{ 258 };
+	static constexpr auto maxDistance = size_t{ 32768 };
+
+	auto bits = BIT_WRITER{ output };
+	auto writeSymbol = [&bits](unsigned int symbol) {
+		if (symbol < 144) { bits.WriteReversed(0x30 + symbol, 8); }
+		else if (symbol < 256) { bits.WriteReversed(0x190 + symbol - 144, 9); }
+		else if (symbol < 280) { bits.WriteReversed(symbol - 256, 7); }
+		else { bits.WriteReversed(0xc0 + symbol - 280, 8); }
+	};
+	auto matchLength = [&data](size_t position, size_t distance) {
+		auto length = size_t{ 0 };
+		auto limit = min(maxMatch, data.size() - position);
+		while (length < limit && data[position + length] == data[position + length - distance]) { ++length; }
+		return length;
+	};
+
+	bits.Write(1, 1);		// Final block
+	bits.Write(1, 2);		// Fixed codes
+	for (auto position = size_t{ 0 }; position < data.size(); ) {
+		auto length = position >= 1 ? matchLength(position, 1) : 0;
+		auto distance = size_t{ 1 };
+		if (rowBytes > 1 && rowBytes <= maxDistance && position >= rowBytes) {
+			if (auto rowLength = matchLength(position, rowBytes); rowLength > length) { length = rowLength; distance = rowBytes; }
+		}
+		if (length < 3) {
+			writeSymbol(data[position++]);
+			continue;
+		}
+
+		auto lengthCode = static_cast<size_t>(upper_bound(lengthBase.begin(), lengthBase.end(), length) - lengthBase.begin()) - 1;
+		writeSymbol(257 + static_cast<unsigned int>(lengthCode));
+		bits.Write(static_cast<uint32_t>(length - lengthBase[lengthCode]), lengthExtra[lengthCode]);
+		auto distanceCode = static_cast<size_t>(upper_bound(distanceBase.begin(), distanceBase.end(), distance) - distanceBase.begin()) - 1;
+		bits.WriteReversed(static_cast<uint32_t>(distanceCode), 5);
+		bits.Write(static_cast<uint32_t>(distance - distanceBase[distanceCode]), distanceExtra[distanceCode]);
+		position += length;
+	}
+	writeSymbol(256);		// End of block
+	bits.Flush();
+}
+
+static uint32_t Crc32(const uint8_t* data, size_t size, uint32_t crc = 0) noexcept {
+	static const auto table = [] {
+		auto entries = array<uint32_t, 256>{ };
+		for (auto i = 0u; i < entries.size(); ++i) {
+			auto value = i;
+			for (auto bit = 0; bit < 8; ++bit) { value = (value & 1u) ? 0xedb88320u ^ (value >> 1) : value >> 1; }
+			entries[i] = value;
+		}
+		return entries;
+	}();
+	crc = ~crc;
+	for (auto i = size_t{ 0 }; i < size; ++i) { crc = table[(crc ^ data[i]) & 0xffu] ^ (crc >> 8); }
+	return ~crc;
+}
+
+static uint32_t Adler32(const vector<uint8_t>& data) noexcept {
+	auto a = uint32_t{ 1 };
+	auto b = uint32_t{ 0 };
+	for (auto byte : data) {
+		a = (a + byte) % 65521u;
+		b = (b + a) % 65521u;
+	}
+	return (b << 16) | a;
+}
+
+static void AppendBigEndian(vector<uint8_t>& bytes, uint32_t value) {
+	for (auto shift = 24; shift >= 0; shift -= 8) { bytes.push_back(static_cast<uint8_t>(value >> shift)); }
+}
+
+static void AppendLittleEndian16(vector<uint8_t>& bytes, unsigned int value) {
+	bytes.push_back(static_cast<uint8_t>(value));
+	bytes.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+static void AppendPngChunk(vector<uint8_t>& png, const char (&type)[5], const vector<uint8_t>& data) {
+	AppendBigEndian(png, static_cast<uint32_t>(data.size()));
+	auto start = png.size();
+	png.insert(png.end(), type, type + 4);
+	png.insert(png.end(), data.begin(), data.end());
+	AppendBigEndian(png, Crc32(png.data() + start, png.size() - start));
+}
+
+// 8-bit palette image, every row unfiltered
+[[nodiscard]] vector<uint8_t> FRAME_EXPORTER::EncodePng(const TIME_SLICE& frame, const LIFE_PALETTE& palette, unsigned int scale) {
+	auto width = frame.Size().width * scale;
+	auto height = frame.Size().height * scale;
+	auto png = vector<uint8_t>{ 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+
+	auto header = vector<uint8_t>{ };
+	AppendBigEndian(header, width);
+	AppendBigEndian(header, height);
+	header.insert(header.end(), { 8, 3, 0, 0, 0 });		// Bit depth, palette color type, deflate, no filtering, no interlace
+	AppendPngChunk(png, "IHDR", header);
+
+	auto colors = vector<uint8_t>{ };
+	for (auto& color : palette) { colors.insert(colors.end(), { color.red, color.green, color.blue }); }
+	AppendPngChunk(png, "PLTE", colors);
+
+	auto pixels = PixelRows(frame, scale, 1);
+	auto compressed = vector<uint8_t>{ 0x78, 0x01 };		// zlib header, 32K window
+	Deflate(pixels, static_cast<size_t>(width) + 1, compressed);
+	AppendBigEndian(compressed, Adler32(pixels));
+	AppendPngChunk(png, "IDAT", compressed);
+
+	AppendPngChunk(png, "IEND", { });
+	return png;
+}
+
+// Logical screen with the palette as its global color table, set to loop forever
+[[nodiscard]] vector<uint8_t> FRAME_EXPORTER::EncodeGifHeader(BOARD_SIZE size, const LIFE_PALETTE& palette, unsigned int scale) {
+	auto gif = vector<uint8_t>{ 'G', 'I', 'F', '8', '9', 'a' };
+	AppendLittleEndian16(gif, size.width * scale);
+	AppendLittleEndian16(gif, size.height * scale);
+	gif.insert(gif.end(), { 0xf2, 0, 0 });		// Global color table of 8 entries, background 0, square pixels
+	for (auto& color : palette) { gif.insert(gif.end(), { color.red, color.green, color.blue }); }
+	gif.insert(gif.end(), { 0x21, 0xff, 11, 'N', 'E', 'T', 'S', 'C', 'A', 'P', 'E', '2', '.', '0', 3, 1, 0, 0, 0 });
+	return gif;
+}
+
+// Full-size image compressed with variable-length LZW, split into sub-blocks of at most 255 bytes
+[[nodiscard]] vector<uint8_t> FRAME_EXPORTER::EncodeGifFrame(const TIME_SLICE& frame, unsigned int scale, unsigned int frameDelay) {
+	static constexpr auto minimumCodeSize = 3u;		// 8 palette entries
+	static constexpr auto clearCode = 1u << minimumCodeSize;
+	static constexpr auto endCode = clearCode + 1;
+	static constexpr auto maxCode = 4095u;
+
+	auto width = frame.Size().width * scale;
+	auto height = frame.Size().height * scale;
+	auto gif = vector<uint8_t>{ };
+	gif.reserve(32);		// Room for the headers before the image data
+	gif.insert(gif.end(), { 0x21, 0xf9, 4, 0 });		// Graphic control: no transparency, no disposal
+	AppendLittleEndian16(gif, frameDelay);
+	gif.insert(gif.end(), { 0, 0, 0x2c, 0, 0, 0, 0 });	// Image at the origin
+	AppendLittleEndian16(gif, width);
+	AppendLittleEndian16(gif, height);
+	gif.insert(gif.end(), { 0, minimumCodeSize });
+
+	// Each code's extension by every palette index, 0 where none is assigned yet
+	auto pixels = PixelRows(frame, scale, 0);
+	auto extensions = vector<uint16_t>((maxCode + 1) * clearCode);
+	auto codes = vector<uint8_t>{ };
+	auto bits = BIT_WRITER{ codes };
+	auto codeSize = minimumCodeSize + 1;
+	auto lastCode = endCode;
+	bits.Write(clearCode, codeSize);
+
+	auto prefix = static_cast<unsigned int>(pixels.front());
+	for (auto i = size_t{ 1 }; i < pixels.size(); ++i) {
+		auto& extension = extensions[prefix * clearCode + pixels[i]];
+		if (extension != 0) { prefix = extension; continue; }
+
+		bits.Write(prefix, codeSize);
+		extension = static_cast<uint16_t>(++lastCode);
+		if (lastCode >= (1u << codeSize)) { ++codeSize; }
+		if (lastCode == maxCode) {
+			bits.Write(clearCode, codeSize);
+			fill(extensions.begin(), extensions.end(), uint16_t{ 0 });
+			codeSize = minimumCodeSize + 1;
+			lastCode = endCode;
+		}
+		prefix = pixels[i];
+	}
+	bits.Write(prefix, codeSize);
+	// Decoders add one more entry on reading the last code & widen with it, so the closing codes must too
+	if (lastCode + 1 >= (1u << codeSize) && codeSize < 12) { ++codeSize; }
+	bits.Write(clearCode, codeSize);
+	bits.Write(endCode, minimumCodeSize + 1);
+	bits.Flush();
+
+	for (auto offset = size_t{ 0 }; offset < codes.size(); offset += 255) {
+		auto blockSize = min<size_t>(255, codes.size() - offset);
+		gif.push_back(static_cast<uint8_t>(blockSize));
+		gif.insert(gif.end(), codes.begin() + offset, codes.begin() + offset + blockSize);
+	}
+	gif.push_back(0);
+	return gif;
+}
+
+[[nodiscard]] vector<uint8_t> FRAME_EXPORTER::EncodeGifTrailer() {
+	return { 0x3b };
+}
+
+[[nodiscard]] filesystem::path FRAME_EXPORTER::PngPath(const filesystem::path& prefix, size_t generationNumber) {
+	auto number = to_string(generationNumber);
+	auto path = prefix;
+	path += "-" + string(number.size() < 6 ? 6 - number.size() : 0, '0') + number + ".png";
+	return path;
+}
+
+[[nodiscard]] filesystem::path FRAME_EXPORTER::TemporaryGifPath() const {
+	auto path = m_Settings.path;
+	path += ".tmp";
+	return path;
+}
+
+FRAME_EXPORTER::FRAME_EXPORTER(EXPORT_SETTINGS settings) : m_Settings{ move(settings) } {
+	if (m_Settings.path.empty()) { throw invalid_argument{ "Export needs an output path." }; }
+	if (m_Settings.scale == 0) { throw invalid_argument{ "Export scale must be at least 1." }; }
+	m_Settings.threads = max<size_t>(m_Settings.threads, 1);
+	m_Settings.queueCapacity = max<size_t>(m_Settings.queueCapacity, 1);
+	if (m_Settings.format == EXPORT_FORMAT::GIF) {
+		m_Gif.open(TemporaryGifPath(), ios::binary | ios::trunc);
+		if (!m_Gif) { throw runtime_error{ "Unable to open " + TemporaryGifPath().string() + " for writing." }; }
+	}
+	for (auto i = size_t{ 0 }; i < m_Settings.threads; ++i) { m_Workers.emplace_back([this] { WorkerLoop(); }); }
+}
+
+FRAME_EXPORTER::~FRAME_EXPORTER() {
+	try { Finish(); }
+	catch (...) { }
+}
+
+void FRAME_EXPORTER::Submit(size_t generationNumber, LIFE_HISTORY::FRAME_HANDLE frame) {
+	auto lock = unique_lock{ m_Mutex };
+	if (m_Closing) { throw logic_error{ "Frames submitted to a finished export." }; }
+	if (!m_Size) {
+		m_Size = frame->Size();
+		auto size = *m_Size;
+		if (size.width * m_Settings.scale > 0xffff || size.height * m_Settings.scale > 0xffff) { throw invalid_argument{ "Exported images are limited to 65535 pixels a side." }; }
+	}
+	if (frame->Size() != *m_Size) { throw invalid_argument{ "Every exported frame must be the same size." }; }
+
+	auto start = chrono::steady_clock::now();
+	m_SpaceFree.wait(lock, [this] { return m_Pending < m_Settings.queueCapacity || m_Error; });
+	m_Stats.stallSeconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	if (m_Error) { rethrow_exception(m_Error); }
+
+	m_Jobs.push_back(JOB{ m_NextSequence++, generationNumber, move(frame) });
+	++m_Pending;
+	m_JobReady.notify_one();
+}
+
+EXPORT_STATS FRAME_EXPORTER::Finish() {
+	if (m_Finished) { return m_Stats; }
+	{
+		auto lock = lock_guard{ m_Mutex };
+		m_Closing = true;
+	}
+	m_JobReady.notify_all();
+	for (auto& worker : m_Workers) { worker.join(); }
+	m_Finished = true;
+
+	if (m_Settings.format == EXPORT_FORMAT::GIF) {
+		if (!m_Error) {
+			if (!m_Size) { m_Size = BOARD_SIZE{ }; }		// Still write a valid, if empty, file
+			if (m_Stats.frames == 0) {
+				auto header = EncodeGifHeader(*m_Size, m_Settings.palette, m_Settings.scale);
+				m_Gif.write(reinterpret_cast<const char*>(header.data()), header.size());
+			}
+			auto trailer = EncodeGifTrailer();
+			m_Gif.write(reinterpret_cast<const char*>(trailer.data()), trailer.size());
+			m_Stats.bytes += trailer.size();
+			m_Gif.flush();
+			if (!m_Gif) { m_Error = make_exception_ptr(runtime_error{ "Failed writing " + TemporaryGifPath().string() + "." }); }
+		}
+		m_Gif.close();
+		if (m_Error) { filesystem::remove(TemporaryGifPath()); }
+		else { filesystem::rename(TemporaryGifPath(), m_Settings.path); }
+	}
+	if (m_Error) { rethrow_exception(m_Error); }
+	return m_Stats;
+}
+
+// After an error the remaining jobs are dropped, so Finish does not wait on work that will be thrown away
+void FRAME_EXPORTER::WorkerLoop() noexcept {
+	auto lock = unique_lock{ m_Mutex };
+	while (true) {
+		m_JobReady.wait(lock, [this] { return m_Closing || !m_Jobs.empty(); });
+		if (m_Jobs.empty() || m_Error) { return; }
+
+		auto job = move(m_Jobs.front());
+		m_Jobs.pop_front();
+		lock.unlock();
+		try {
+			Encode(job);
+			lock.lock();
+		}
+		catch (...) {
+			lock.lock();
+			if (!m_Error) { m_Error = current_exception(); }
+			m_SpaceFree.notify_all();
+			m_JobReady.notify_all();
+		}
+	}
+}
+
+// PNG frames go straight to their own files, while GIF frames queue up until all earlier ones are written
+void FRAME_EXPORTER::Encode(const JOB& job) {
+	if (m_Settings.format == EXPORT_FORMAT::PNG_SEQUENCE) {
+		auto png = EncodePng(*job.frame, m_Settings.palette, m_Settings.scale);
+		WriteFileAtomically(PngPath(m_Settings.path, job.generation), [&png](ostream& stream) {
+			stream.write(reinterpret_cast<const char*>(png.data()), png.size());
+		});
+		auto lock = lock_guard{ m_Mutex };
+		++m_Stats.frames;
+		m_Stats.bytes += png.size();
+		--m_Pending;
+		m_SpaceFree.notify_one();
+		return;
+	}
+
+	auto gif = EncodeGifFrame(*job.frame, m_Settings.scale, m_Settings.frameDelay);
+	auto lock = unique_lock{ m_Mutex };
+	m_Encoded.emplace(job.sequence, move(gif));
+	WriteEncoded(lock);
+}
+
+// Only one thread can find the next frame in sequence ready, so the file is never written from two threads at once
+void FRAME_EXPORTER::WriteEncoded(unique_lock<mutex>& lock) {
+	while (!m_Encoded.empty() && m_Encoded.begin()->first == m_NextToWrite) {
+		auto gif = move(m_Encoded.begin()->second);
+		m_Encoded.erase(m_Encoded.begin());
+		if (m_NextToWrite == 0) {
+			auto header = EncodeGifHeader(*m_Size, m_Settings.palette, m_Settings.scale);
+			gif.insert(gif.begin(), header.begin(), header.end());
+		}
+		lock.unlock();
+		m_Gif.write(reinterpret_cast<const char*>(gif.data()), gif.size());
+		lock.lock();
+		if (!m_Gif) { throw runtime_error{ "Failed writing " + TemporaryGifPath().string() + "." }; }
+
+		++m_NextToWrite;
+		++m_Stats.frames;
+		m_Stats.bytes += gif.size();
+		--m_Pending;
+		m_SpaceFree.notify_one();
+	}
+}
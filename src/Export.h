@@ -0,0 +1,90 @@
+#ifndef FRAME_EXPORTER_CLASS_H
+#define FRAME_EXPORTER_CLASS_H
+#include "framework.h"
+#include "CELL.h"
+#include "Palette.h"
+
+enum class EXPORT_FORMAT {
+	PNG_SEQUENCE = 0,		// One numbered image per generation
+	GIF = 1					// One looping animation
+};
+
+struct EXPORT_SETTINGS {
+	EXPORT_FORMAT format{ EXPORT_FORMAT::GIF };
+	std::filesystem::path path{ };				// GIF file, or the prefix of each numbered PNG file
+	LIFE_PALETTE palette{ extendedPalette };
+	unsigned int scale{ 4 };					// Pixels along each side of a cell
+	unsigned int frameDelay{ 10 };				// GIF only, hundredths of a second per frame
+	size_t threads{ 1 };						// Encoding threads, in addition to the one submitting frames
+	size_t queueCapacity{ 16 };					// Frames submitted but not yet written
+};
+
+struct EXPORT_STATS {
+	size_t frames{ 0 };
+	size_t bytes{ 0 };
+	double stallSeconds{ 0.0 };					// Time Submit spent waiting for room in the queue
+};
+
+// FRAME_EXPORTER encodes generations to images on background threads while the caller keeps simulating
+// Frames are shared as FRAME_HANDLEs (see LIFE_HISTORY::READER), so submitting one copies nothing
+// Submit blocks once queueCapacity frames are pending, which bounds memory when encoding falls behind
+// PNG frames are written independently; GIF frames are encoded in parallel, then appended in submission order
+// Both encoders are self-contained (no image libraries), so exporting runs headless on any platform
+//
+// Files are written under a temporary name & renamed once complete, like other saves
+// An encoding or file error stops the export & is thrown from the next Submit or Finish
+class FRAME_EXPORTER {
+	struct JOB {
+		size_t sequence{ 0 };
+		size_t generation{ 0 };
+		LIFE_HISTORY::FRAME_HANDLE frame{ };
+	};
+
+	EXPORT_SETTINGS m_Settings{ };
+	std::vector<std::thread> m_Workers{ };
+	std::mutex m_Mutex{ };
+	std::condition_variable m_JobReady{ };
+	std::condition_variable m_SpaceFree{ };
+	std::deque<JOB> m_Jobs{ };
+	size_t m_Pending{ 0 };								// Submitted but not yet written
+	size_t m_NextSequence{ 0 };
+	size_t m_NextToWrite{ 0 };							// GIF only
+	std::map<size_t, std::vector<std::uint8_t>> m_Encoded{ };	// GIF frames waiting on earlier ones
+	std::optional<BOARD_SIZE> m_Size{ };
+	std::ofstream m_Gif{ };
+	std::exception_ptr m_Error{ };
+	bool m_Closing{ false };
+	bool m_Finished{ false };
+	EXPORT_STATS m_Stats{ };
+
+	void WorkerLoop() noexcept;
+	void Encode(const JOB& job);
+	void WriteEncoded(std::unique_lock<std::mutex>& lock);
+	[[nodiscard]] std::filesystem::path TemporaryGifPath() const;
+
+public:
+	// Throws std::invalid_argument for an unusable setting
+	explicit FRAME_EXPORTER(EXPORT_SETTINGS settings);
+	FRAME_EXPORTER(const FRAME_EXPORTER&) = delete;
+	FRAME_EXPORTER& operator=(const FRAME_EXPORTER&) = delete;
+	~FRAME_EXPORTER();
+
+	// Every frame must have the same size as the first
+	void Submit(size_t generationNumber, LIFE_HISTORY::FRAME_HANDLE frame);
+
+	// Wait for every submitted frame to be written & complete the files
+	EXPORT_STATS Finish();
+
+	// Path of the PNG written for generation #
+	[[nodiscard]] static std::filesystem::path PngPath(const std::filesystem::path& prefix, size_t generationNumber);
+
+	// Complete image file holding one frame
+	[[nodiscard]] static std::vector<std::uint8_t> EncodePng(const TIME_SLICE& frame, const LIFE_PALETTE& palette, unsigned int scale);
+
+	// Animation header, one frame, & the closing trailer, which concatenate into a complete GIF
+	[[nodiscard]] static std::vector<std::uint8_t> EncodeGifHeader(BOARD_SIZE size, const LIFE_PALETTE& palette, unsigned int scale);
+	[[nodiscard]] static std::vector<std::uint8_t> EncodeGifFrame(const TIME_SLICE& frame, unsigned int scale, unsigned int frameDelay);
+	[[nodiscard]] static std::vector<std::uint8_t> EncodeGifTrailer();
+};
+
+#endif // !FRAME_EXPORTER_CLASS_H
@@ -0,0 +1,140 @@
+#ifndef FIXED_TIME_SLICE_CLASS_H
+#define FIXED_TIME_SLICE_CLASS_H
+#include "framework.h"
+#include "CELL.h"
+
+// FIXED_TIME_SLICE is a TIME_SLICE whose board size is chosen at compile time, for small boards where latency matters most
+// The padded layout is a std::array, so a whole board is one block of (Width + 2) x (Height + 2) bytes with no heap allocation
+// Stride & stencil offsets are constants, so the neighbor sum is fully unrolled & each row sweep has a known trip count
+// Cells are packed & padded exactly as in TIME_SLICE, so frames convert either way by a plain copy & hash equal
+//
+// Larger boards stay on the runtime-sized TIME_SLICE, whose tiles spread across a thread pool
+template <unsigned int Width, unsigned int Height>
+class FIXED_TIME_SLICE {
+	static_assert(Width > 0 && Height > 0, "A board needs at least one cell.");
+	static_assert(sizeof(TIME_SLICE::CELL) == 1, "Layouts are copied as packed cell bytes.");
+
+	static constexpr std::ptrdiff_t stride{ Width + 2 };
+	static constexpr size_t layoutSize{ static_cast<size_t>(stride) * (Height + 2) };
+	static constexpr auto willLiveShift{ 2u };
+
+	std::array<std::uint8_t, layoutSize> m_Layout{ };
+
+	[[nodiscard]] static constexpr size_t Index(CELL_POSITION position) noexcept { return static_cast<size_t>(position.row + 1) * stride + position.column + 1; }
+
+	// One generation over the board, leaving the padding of the next layout untouched
+	// Neighbor sums are taken over plain byte arrays in a separate pass, which the compiler vectorizes
+	// Summing the WILL_LIVE flags in place (worth 4 each) avoids byte shifts, which most vector units lack
+	// Only the final table lookup runs cell by cell
+	static constexpr void Step(const std::array<std::uint8_t, layoutSize>& previous, std::array<std::uint8_t, layoutSize>& next) noexcept {
+		constexpr auto willLive = static_cast<std::uint8_t>(LIFE_STATE::WILL_LIVE);
+		auto sums = std::array<std::uint8_t, Width>{ };
+		for (auto row = std::ptrdiff_t{ 1 }; row <= Height; ++row) {
+			const auto* above = previous.data() + (row - 1) * stride;
+			const auto* middle = above + stride;
+			const auto* below = middle + stride;
+			for (auto column = size_t{ 0 }; column < Width; ++column) {
+				sums[column] = static_cast<std::uint8_t>((above[column] & willLive) + (above[column + 1] & willLive) + (above[column + 2] & willLive)
+					+ (middle[column] & willLive) + (middle[column + 2] & willLive)
+					+ (below[column] & willLive) + (below[column + 1] & willLive) + (below[column + 2] & willLive));
+			}
+			auto* nextCells = next.data() + row * stride + 1;
+			for (auto column = size_t{ 0 }; column < Width; ++column) {
+				nextCells[column] = lifeTransitionTable[(middle[column + 1] & cellStateMask) | (sums[column] << (cellCountShift - willLiveShift))];
+			}
+		}
+	}
+
+public:
+	static constexpr BOARD_SIZE size{ Width, Height };
+
+	TIME_SLICE::STATUS status{ TIME_SLICE::STATUS::MANUALLY_CHANGED };
+
+	constexpr FIXED_TIME_SLICE() = default;
+
+	// The frame must be of the same size
+	explicit FIXED_TIME_SLICE(const TIME_SLICE& frame) noexcept : status{ frame.status } {
+		for (auto i = size_t{ 0 }; i < layoutSize; ++i) { m_Layout[i] = frame.m_Layout[i].bits; }
+	}
+
+	[[nodiscard]] TIME_SLICE ToTimeSlice() const {
+		auto frame = TIME_SLICE{ size };
+		frame.status = status;
+		for (auto i = size_t{ 0 }; i < layoutSize; ++i) { frame.m_Layout[i].bits = m_Layout[i]; }
+		frame.RebuildPyramid();
+		return frame;
+	}
+
+	[[nodiscard]] constexpr LIFE_STATE LifeState(CELL_POSITION position) const noexcept { return static_cast<LIFE_STATE>(m_Layout[Index(position)] & cellStateMask); }
+	[[nodiscard]] constexpr unsigned int NeighborCount(CELL_POSITION position) const noexcept { return m_Layout[Index(position)] >> cellCountShift; }
+
+	// Same as TIME_SLICE::PROXY_CELL::TogleDeadAlive
+	constexpr LIFE_STATE TogleDeadAlive(CELL_POSITION position) noexcept {
+		auto& cell = m_Layout[Index(position)];
+		auto alive = static_cast<std::uint8_t>(LIFE_STATE::ALIVE);
+		cell = lifePredictionTable[cell ^ alive];
+		auto increment = (cell & alive) ? 1 : -1;
+		if (status == TIME_SLICE::STATUS::GENERATED) { status = TIME_SLICE::STATUS::MANUALLY_CHANGED; }
+
+		// The padding must stay dead, so neighbors off the board are skipped
+		auto lastRow = std::min(position.row + 1, Height - 1);
+		auto lastColumn = std::min(position.column + 1, Width - 1);
+		for (auto row = position.row > 0 ? position.row - 1 : 0u; row <= lastRow; ++row) {
+			for (auto column = position.column > 0 ? position.column - 1 : 0u; column <= lastColumn; ++column) {
+				if (row == position.row && column == position.column) { continue; }
+				auto& neighborCell = m_Layout[Index(CELL_POSITION{ row, column })];
+				neighborCell = lifePredictionTable[static_cast<std::uint8_t>(neighborCell + increment * (1 << cellCountShift))];
+			}
+		}
+		return static_cast<LIFE_STATE>(cell & cellStateMask);
+	}
+
+	[[nodiscard]] constexpr FIXED_TIME_SLICE Next() const noexcept {
+		auto next = FIXED_TIME_SLICE{ };
+		next.status = TIME_SLICE::STATUS::GENERATED;
+		Step(m_Layout, next.m_Layout);
+		return next;
+	}
+
+	// Advance in place, alternating between this layout & one scratch layout on the stack
+	constexpr FIXED_TIME_SLICE& Advance(size_t generations = 1) noexcept {
+		if (generations == 0) { return *this; }
+		auto scratch = std::array<std::uint8_t, layoutSize>{ };
+		for (auto i = size_t{ 0 }; i + 1 < generations; i += 2) {
+			Step(m_Layout, scratch);
+			Step(scratch, m_Layout);
+		}
+		if (generations % 2 == 1) {
+			Step(m_Layout, scratch);
+			m_Layout = scratch;
+		}
+		status = TIME_SLICE::STATUS::GENERATED;
+		return *this;
+	}
+
+	// Same value as TIME_SLICE::Hash() of an equal frame
+	[[nodiscard]] constexpr std::uint64_t Hash() const noexcept {
+		auto hash = std::uint64_t{ 14695981039346656037ull };
+		for (auto cell : m_Layout) { hash = (hash ^ cell) * 1099511628211ull; }
+		return hash;
+	}
+};
+
+// The kernel runs at compile time too: a horizontal blinker must turn vertical, then return with identical cells
+constexpr bool FixedBlinkerOscillates() noexcept {
+	auto alive = [](const FIXED_TIME_SLICE<5, 5>& board, unsigned int row, unsigned int column) {
+		return (static_cast<std::uint8_t>(board.LifeState(CELL_POSITION{ row, column })) & static_cast<std::uint8_t>(LIFE_STATE::ALIVE)) != 0;
+	};
+	auto board = FIXED_TIME_SLICE<5, 5>{ };
+	for (auto column = 1u; column <= 3u; ++column) { board.TogleDeadAlive(CELL_POSITION{ 2, column }); }
+	board.Advance();
+	auto first = board.Next().Next();
+	return alive(board, 1, 2) && alive(board, 2, 2) && alive(board, 3, 2) && !alive(board, 2, 1) && !alive(board, 2, 3)
+		&& board.Hash() == first.Hash() && board.NeighborCount(CELL_POSITION{ 2, 1 }) == 3;
+}
+static_assert(FixedBlinkerOscillates(), "The compile-time sized kernel must step a blinker.");
+
+// Size of the GUI board, which the SWEEP engine steps through the fixed-size path
+using DEFAULT_FIXED_TIME_SLICE = FIXED_TIME_SLICE<defaultBoardSize.width, defaultBoardSize.height>;
+
+#endif // !FIXED_TIME_SLICE_CLASS_H
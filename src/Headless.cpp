@@ -0,0 +1,1282 @@
+// Headless.cpp : Console entry point for running the simulation engine without the GUI.
+//
+// Usage:
+//   Kata-Game-of-Life-Headless replay <log file> [reference|sweep]
+//   Kata-Game-of-Life-Headless record <log file> <generations> [width height]
+//   Kata-Game-of-Life-Headless jump <generations> [temporal depth] [width height]
+//   Kata-Game-of-Life-Headless batch <boards> <generations>
+//   Kata-Game-of-Life-Headless kernel <generations> [width height]
+//   Kata-Game-of-Life-Headless export <gif|png> <output> <generations> [simple|extended] [scale] [session file]
+//   Kata-Game-of-Life-Headless gif <generations> [width height]
+//   Kata-Game-of-Life-Headless zoom <generations> <queries> [width height]
+//   Kata-Game-of-Life-Headless census <generations> [width height]
+//   Kata-Game-of-Life-Headless numa <generations> [width height]
+//   Kata-Game-of-Life-Headless conform <generations> [seed] [width height]
+//   Kata-Game-of-Life-Headless readers <threads> <generations> [width height]
+//   Kata-Game-of-Life-Headless distribute <workers> <width> <height> <generations> [halo depth] [snapshot file]
+//   Kata-Game-of-Life-Headless serve <port> <generations> [generations per second] [width height]
+//   Kata-Game-of-Life-Headless stream <clients> <generations> [width height]
+//
+
+#include "framework.h"
+#include "CELL.h"
+#include "FixedTimeSlice.h"
+#include "ReplayLog.h"
+#include "SessionFile.h"
+#include "Distributed.h"
+#include "Export.h"
+#include "Census.h"
+#include "Stream.h"
+#include "Utilities.h"
+#include <iomanip>
+#include <iostream>
+
+using namespace std;
+
+LIFE_HISTORY::ENGINE ParseEngine(const string& name) {
+    if (name == "reference") { return LIFE_HISTORY::ENGINE::REFERENCE; }
+    if (name == "sweep") { return LIFE_HISTORY::ENGINE::SWEEP; }
+    throw invalid_argument{ "Unknown engine: " + name };
+}
+
+// Replay a recorded session at full speed and check every generation against its recorded hash
+int ReplayCommand(const vector<string>& arguments) {
+    if (arguments.empty()) { throw invalid_argument{ "replay requires a log file." }; }
+    auto engine = arguments.size() > 1 ? ParseEngine(arguments[1]) : LIFE_HISTORY::ENGINE::SWEEP;
+    auto stream = ifstream{ arguments[0], ios::binary };
+    if (!stream) { throw runtime_error{ "Unable to open " + arguments[0] }; }
+
+    auto result = REPLAY_LOG::Replay(stream, engine);
+    const auto& history = result.history;
+    auto cells = static_cast<double>(history.Size().CellCount());
+    cout << "Board:        " << history.Size().width << 'x' << history.Size().height << '\n'
+        << "Generations:  " << history.FirstGeneration() << " -> " << history.Generation() << '\n'
+        << "Edits:        " << result.toggles << '\n'
+        << "Advances:     " << result.advances << '\n'
+        << "Seconds:      " << result.seconds << '\n'
+        << "Cells/second: " << (result.seconds > 0 ? result.advances * cells / result.seconds : 0.0) << '\n'
+        << "Final hash:   " << hex << history[history.Generation()].Hash() << dec << '\n';
+    if (result.mismatches > 0) {
+        cout << "MISMATCH: " << result.mismatches << " generations differ from the recording, first at generation " << result.firstMismatch << '\n';
+        return 1;
+    }
+    cout << "All generations match the recording\n";
+    return 0;
+}
+
+// Random starting board, the same every run
+// Each cell is decided by its position alone, so a board of any size can be produced in pieces
+bool SoupCellAlive(CELL_POSITION position) {
+    auto bits = (static_cast<uint64_t>(position.row) << 32 | position.column) + 0x9e3779b97f4a7c15ull;
+    bits = (bits ^ (bits >> 30)) * 0xbf58476d1ce4e5b9ull;
+    bits = (bits ^ (bits >> 27)) * 0x94d049bb133111ebull;
+    return (bits ^ (bits >> 31)) % 3 == 0;
+}
+
+void SeedSoup(LIFE_HISTORY& history) {
+    auto& frame = history.GetLatestGeneration();
+    for (auto position : frame.Positions()) {
+        if (SoupCellAlive(position)) { frame[position].TogleDeadAlive(); }
+    }
+}
+
+// Board size from a pair of optional arguments, defaulting to the GUI board
+BOARD_SIZE ParseBoardSize(const vector<string>& arguments, size_t first) {
+    if (arguments.size() <= first) { return defaultBoardSize; }
+    if (arguments.size() == first + 1) { throw invalid_argument{ "A board needs both a width and a height." }; }
+    auto size = BOARD_SIZE{ static_cast<unsigned int>(stoul(arguments[first])), static_cast<unsigned int>(stoul(arguments[first + 1])) };
+    if (size.CellCount() == 0) { throw invalid_argument{ "A board needs at least one cell." }; }
+    return size;
+}
+
+constexpr auto recordedJumpLimit = size_t{ 40 };    // generations
+
+// Record a seeded soup through REPLAY_LOG the way the GUI would, with edits, single steps & temporally blocked jumps
+// Then replay the log on both engines, which must reproduce every recorded generation bit for bit & end on the recorded hash
+int RecordCommand(const vector<string>& arguments) {
+    if (arguments.size() < 2) { throw invalid_argument{ "record requires a log file and a generation count." }; }
+    auto path = filesystem::path{ arguments[0] };
+    auto generations = static_cast<size_t>(stoull(arguments[1]));
+    auto history = LIFE_HISTORY{ ParseBoardSize(arguments, 2) };
+    auto size = history.Size();
+    SeedSoup(history);
+
+    auto log = REPLAY_LOG{ };
+    log.Start(path, history);
+    auto bits = uint64_t{ 0x9e3779b97f4a7c15ull };
+    auto random = [&bits](uint64_t bound) {
+        bits ^= bits << 13;
+        bits ^= bits >> 7;
+        bits ^= bits << 17;
+        return bits % bound;
+    };
+    auto toggles = size_t{ 0 };
+    auto advances = size_t{ 0 };
+    while (history.Generation() < generations) {
+        for (auto edits = random(4); edits > 0; --edits, ++toggles) {
+            auto position = CELL_POSITION{ static_cast<unsigned int>(random(size.height)), static_cast<unsigned int>(random(size.width)) };
+            history.GetLatestGeneration()[position].TogleDeadAlive();
+            log.RecordToggle(history.Generation(), position);
+        }
+        auto remaining = generations - history.Generation();
+        if (random(2) == 0) { history.Advance(); }
+        else { history.Advance(min(remaining, 2 + random(recordedJumpLimit - 1))); }
+        log.RecordAdvance(history);
+        ++advances;
+    }
+    if (!log) { throw runtime_error{ "Unable to write " + path.string() }; }
+    log.Stop();
+    auto recordedHash = history[history.Generation()].Hash();
+    cout << "Recorded:     " << toggles << " edits & " << advances << " steps or jumps to generation " << history.Generation()
+        << " on " << size.width << 'x' << size.height << ", final hash " << hex << recordedHash << dec << '\n';
+
+    auto failed = false;
+    for (auto engine : { LIFE_HISTORY::ENGINE::REFERENCE, LIFE_HISTORY::ENGINE::SWEEP }) {
+        auto stream = ifstream{ path, ios::binary };
+        if (!stream) { throw runtime_error{ "Unable to open " + path.string() }; }
+        auto result = REPLAY_LOG::Replay(stream, engine);
+        auto replayedHash = result.history[result.history.Generation()].Hash();
+        cout << left << setw(14) << (engine == LIFE_HISTORY::ENGINE::REFERENCE ? "Reference:" : "Sweep:") << right << result.seconds << " s, final hash " << hex << replayedHash << dec << '\n';
+        if (result.mismatches > 0) {
+            cout << "MISMATCH: " << result.mismatches << " generations differ from the recording, first at generation " << result.firstMismatch << '\n';
+            failed = true;
+        }
+        else if (result.toggles != toggles || result.advances != advances || result.history.Generation() != history.Generation() || replayedHash != recordedHash) {
+            cout << "MISMATCH: the replay did not end on the recorded generation\n";
+            failed = true;
+        }
+    }
+    if (failed) { return 1; }
+    cout << "Both engines replay the recording bit for bit\n";
+    return 0;
+}
+
+// Bytes the adjacency list that stencil offsets replaced would take for a board: a vector of neighbor positions for every cell
+// Allocator overhead per vector is left out, so the true cost was higher still
+size_t AdjacencyListBytes(BOARD_SIZE size) {
+    auto bytes = sizeof(vector<vector<CELL_POSITION>>) + size.CellCount() * sizeof(vector<CELL_POSITION>);
+    for (auto position : ALL_CELL_POSITIONS{ size }) {
+        auto neighbors = NEIGHBOR_POSITIONS{ position, size };
+        bytes += static_cast<size_t>(distance(neighbors.begin(), neighbors.end())) * sizeof(CELL_POSITION);
+    }
+    return bytes;
+}
+
+// Compare stepping one generation at a time against a single temporally blocked jump
+// The per-cell reference engine also steps the same soup, & the memory of one frame is set against the adjacency list it no longer needs
+int JumpCommand(const vector<string>& arguments) {
+    if (arguments.empty()) { throw invalid_argument{ "jump requires a generation count." }; }
+    auto generations = static_cast<size_t>(stoull(arguments[0]));
+    auto depth = arguments.size() > 1 ? static_cast<size_t>(stoull(arguments[1])) : LIFE_HISTORY{ }.TemporalDepth();
+    auto size = ParseBoardSize(arguments, 2);
+
+    auto time = [](auto&& work) {
+        auto start = chrono::steady_clock::now();
+        work();
+        return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    };
+    auto pool = make_shared<THREAD_POOL>();
+    auto reference = LIFE_HISTORY{ size, pool };
+    auto stepped = LIFE_HISTORY{ size, pool };
+    auto jumped = LIFE_HISTORY{ size, pool };
+    reference.Engine(LIFE_HISTORY::ENGINE::REFERENCE);
+    jumped.TemporalDepth(depth);
+    SeedSoup(reference);
+    SeedSoup(stepped);
+    SeedSoup(jumped);
+    auto referenceSeconds = time([&] { for (auto i = size_t{ 0 }; i < generations; ++i) { reference.Advance(); } });
+    auto steppedSeconds = time([&] { for (auto i = size_t{ 0 }; i < generations; ++i) { stepped.Advance(); } });
+    auto jumpedSeconds = time([&] { jumped.Advance(generations); });
+
+    auto cells = static_cast<double>(size.CellCount()) * generations;
+    auto boardCells = static_cast<double>(size.CellCount());
+    cout << "Board:        " << size.width << 'x' << size.height << '\n'
+        << "Frame memory: " << stepped[stepped.Generation()].MemoryBytes() / boardCells << " bytes/cell (the adjacency list alone took "
+        << AdjacencyListBytes(size) / boardCells << " bytes/cell)\n"
+        << "Reference:    " << referenceSeconds << " s (" << referenceSeconds * 1e9 / cells << " ns/cell)\n"
+        << "Stepped:      " << steppedSeconds << " s (" << steppedSeconds * 1e9 / cells << " ns/cell)\n"
+        << "Jumped:       " << jumpedSeconds << " s (" << jumpedSeconds * 1e9 / cells << " ns/cell) at depth " << depth << '\n'
+        << "Speedup:      " << (jumpedSeconds > 0 ? steppedSeconds / jumpedSeconds : 0.0) << "x\n";
+    if (reference[reference.Generation()].Hash() != stepped[stepped.Generation()].Hash()) {
+        cout << "MISMATCH: stepping did not reproduce the reference generation\n";
+        return 1;
+    }
+    if (stepped[stepped.Generation()].Hash() != jumped[jumped.Generation()].Hash()) {
+        cout << "MISMATCH: the jump did not reproduce the stepped generation\n";
+        return 1;
+    }
+    cout << "Final generations match\n";
+    return 0;
+}
+
+constexpr auto batchCheckLimit = size_t{ 16 };     // boards
+
+// Run many independent GUI-sized boards on the compile-time sized engine, one board per pool task
+// Board # is cut from a tall soup, so every board differs yet can be rebuilt on its own
+// The first few boards are also run through the reference engine to check the result
+int BatchCommand(const vector<string>& arguments) {
+    if (arguments.size() < 2) { throw invalid_argument{ "batch requires a board count and a generation count." }; }
+    auto boards = static_cast<size_t>(stoull(arguments[0]));
+    auto generations = static_cast<size_t>(stoull(arguments[1]));
+    constexpr auto size = DEFAULT_FIXED_TIME_SLICE::size;
+
+    auto seed = [size](size_t board) {
+        auto frame = DEFAULT_FIXED_TIME_SLICE{ };
+        for (auto position : ALL_CELL_POSITIONS{ size }) {
+            if (SoupCellAlive(CELL_POSITION{ static_cast<unsigned int>(board * size.height + position.row), position.column })) { frame.TogleDeadAlive(position); }
+        }
+        return frame;
+    };
+    auto hashes = vector<uint64_t>(boards);
+    auto pool = make_shared<THREAD_POOL>();
+    auto start = chrono::steady_clock::now();
+    pool->ForEach(boards, [&](size_t board) { hashes[board] = seed(board).Advance(generations).Hash(); });
+    auto seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    auto combined = uint64_t{ 0 };
+    for (auto hash : hashes) { combined = (combined ^ hash) * 1099511628211ull; }
+    auto cells = static_cast<double>(size.CellCount()) * boards * generations;
+    cout << "Boards:       " << boards << " of " << size.width << 'x' << size.height << " on " << pool->ThreadCount() << " threads\n"
+        << "Board memory: " << static_cast<double>(sizeof(DEFAULT_FIXED_TIME_SLICE)) / size.CellCount() << " bytes/cell (the adjacency list alone took "
+        << static_cast<double>(AdjacencyListBytes(size)) / size.CellCount() << " bytes/cell)\n"
+        << "Seconds:      " << seconds << " (" << (cells > 0 ? seconds * 1e9 / cells : 0.0) << " ns/cell, " << (seconds > 0 ? boards / seconds : 0.0) << " boards/s)\n"
+        << "Batch hash:   " << hex << combined << dec << '\n';
+
+    for (auto board = size_t{ 0 }; board < min(boards, batchCheckLimit); ++board) {
+        auto history = LIFE_HISTORY{ size, pool };
+        history.Engine(LIFE_HISTORY::ENGINE::REFERENCE);
+        history.GetLatestGeneration() = seed(board).ToTimeSlice();
+        history.Advance(generations);
+        if (history[history.Generation()].Hash() != hashes[board]) {
+            cout << "MISMATCH: board " << board << " differs from the reference engine\n";
+            return 1;
+        }
+    }
+    cout << "Checked boards match the reference engine\n";
+    return 0;
+}
+
+// Packed cells of a soup, each holding its ALIVE flag & its live neighbor count, as the prediction step sees them
+vector<uint8_t> PackedSoupCells(BOARD_SIZE size) {
+    auto alive = [size](long long row, long long column) {
+        return row >= 0 && column >= 0 && row < size.height && column < size.width
+            && SoupCellAlive(CELL_POSITION{ static_cast<unsigned int>(row), static_cast<unsigned int>(column) });
+    };
+    auto cells = vector<uint8_t>{ };
+    cells.reserve(size.CellCount());
+    for (auto position : ALL_CELL_POSITIONS{ size }) {
+        auto count = 0u;
+        for (auto row = -1; row <= 1; ++row) {
+            for (auto column = -1; column <= 1; ++column) {
+                if ((row != 0 || column != 0) && alive(position.row + row, position.column + column)) { ++count; }
+            }
+        }
+        auto state = alive(position.row, position.column) ? static_cast<uint8_t>(LIFE_STATE::ALIVE) : uint8_t{ 0 };
+        cells.push_back(static_cast<uint8_t>(state | (count << cellCountShift)));
+    }
+    return cells;
+}
+
+// Micro-benchmark of the generation kernel on one soup
+// First the WILL_LIVE decision alone, branching per cell on the neighbor count as the original kernel did, against the prediction table
+// An optimizing compiler may turn that lone branch into a vectorized select, so the gain shows in the second part:
+// whole generations, the per-cell reference engine against the table-driven sweep
+int KernelCommand(const vector<string>& arguments) {
+    if (arguments.empty()) { throw invalid_argument{ "kernel requires a generation count." }; }
+    auto generations = static_cast<size_t>(stoull(arguments[0]));
+    auto size = ParseBoardSize(arguments, 1);
+
+    auto time = [](auto&& work) {
+        auto start = chrono::steady_clock::now();
+        work();
+        return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    };
+    const auto cells = PackedSoupCells(size);
+    auto branchy = vector<uint8_t>(cells.size());
+    auto table = vector<uint8_t>(cells.size());
+    constexpr auto aliveBit = static_cast<uint8_t>(LIFE_STATE::ALIVE);
+    constexpr auto willLiveBit = static_cast<uint8_t>(LIFE_STATE::WILL_LIVE);
+    auto branchySeconds = time([&] {
+        for (auto i = size_t{ 0 }; i < generations; ++i) {
+            for (auto cell = size_t{ 0 }; cell < cells.size(); ++cell) {
+                auto neighborCount = cells[cell] >> cellCountShift;
+                auto next = static_cast<uint8_t>(cells[cell] & ~willLiveBit);
+                if (neighborCount == 3 || (neighborCount == 2 && (cells[cell] & aliveBit))) { next |= willLiveBit; }
+                branchy[cell] = next;
+            }
+        }
+    });
+    auto tableSeconds = time([&] {
+        for (auto i = size_t{ 0 }; i < generations; ++i) {
+            for (auto cell = size_t{ 0 }; cell < cells.size(); ++cell) {
+                table[cell] = lifePredictionTable[cells[cell]];
+            }
+        }
+    });
+
+    auto histories = array<LIFE_HISTORY, 2>{ LIFE_HISTORY{ size }, LIFE_HISTORY{ size } };
+    histories[0].Engine(LIFE_HISTORY::ENGINE::REFERENCE);
+    auto engineSeconds = array<double, 2>{ };
+    for (auto engine = size_t{ 0 }; engine < histories.size(); ++engine) {
+        SeedSoup(histories[engine]);
+        engineSeconds[engine] = time([&] { for (auto i = size_t{ 0 }; i < generations; ++i) { histories[engine].Advance(); } });
+    }
+
+    auto perCell = [updates = static_cast<double>(size.CellCount()) * generations](double seconds) { return updates > 0 ? seconds * 1e9 / updates : 0.0; };
+    auto speedup = [](double slow, double fast) { return fast > 0 ? slow / fast : 0.0; };
+    cout << "Board:        " << size.width << 'x' << size.height << ", " << generations << " generations\n"
+        << "Rule branchy: " << branchySeconds << " s (" << perCell(branchySeconds) << " ns/cell)\n"
+        << "Rule table:   " << tableSeconds << " s (" << perCell(tableSeconds) << " ns/cell), " << speedup(branchySeconds, tableSeconds) << "x\n"
+        << "Reference:    " << engineSeconds[0] << " s (" << perCell(engineSeconds[0]) << " ns/cell)\n"
+        << "Sweep:        " << engineSeconds[1] << " s (" << perCell(engineSeconds[1]) << " ns/cell), " << speedup(engineSeconds[0], engineSeconds[1]) << "x\n";
+    if (branchy != table) {
+        cout << "MISMATCH: the prediction table disagrees with the branching rule\n";
+        return 1;
+    }
+    if (histories[0][histories[0].Generation()].Hash() != histories[1][histories[1].Generation()].Hash()) {
+        cout << "MISMATCH: the sweep did not reproduce the reference generation\n";
+        return 1;
+    }
+    cout << "Predictions & final generations match\n";
+    return 0;
+}
+
+// Encode generations to images on background threads while this thread produces them
+// Without a session file a soup is simulated live, otherwise the generations of a GUI session are read back from the start
+int ExportCommand(const vector<string>& arguments) {
+    if (arguments.size() < 3) { throw invalid_argument{ "export requires a format, an output path, and a generation count." }; }
+    auto settings = EXPORT_SETTINGS{ };
+    if (arguments[0] == "gif") { settings.format = EXPORT_FORMAT::GIF; }
+    else if (arguments[0] == "png") { settings.format = EXPORT_FORMAT::PNG_SEQUENCE; }
+    else { throw invalid_argument{ "Unknown export format: " + arguments[0] }; }
+    settings.path = arguments[1];
+    auto generations = static_cast<size_t>(stoull(arguments[2]));
+    if (arguments.size() > 3) {
+        if (arguments[3] == "simple") { settings.palette = simplePalette; }
+        else if (arguments[3] != "extended") { throw invalid_argument{ "Unknown palette: " + arguments[3] }; }
+    }
+    if (arguments.size() > 4) { settings.scale = static_cast<unsigned int>(stoul(arguments[4])); }
+    settings.threads = max<size_t>(THREAD_POOL::DefaultThreadCount(), 2) - 1;
+
+    auto live = arguments.size() <= 5;
+    auto history = LIFE_HISTORY{ };
+    if (live) { SeedSoup(history); }
+    else {
+        auto stream = ifstream{ arguments[5], ios::binary };
+        if (!stream) { throw runtime_error{ "Unable to open " + arguments[5] }; }
+        static_cast<void>(SESSION_HEADER::Read(stream));       // The display state has no bearing on the images
+        history = LIFE_HISTORY::Load(stream);
+    }
+
+    auto exporter = FRAME_EXPORTER{ settings };
+    auto waitSeconds = 0.0;
+    auto start = chrono::steady_clock::now();
+    auto first = history.FirstGeneration();
+    auto last = live ? generations : min(first + generations, history.Generation());
+
+    // Live generations are simulated while the one before is being submitted
+    auto waitStart = start;
+    for (const auto& generation : live ? history.RunAsync(first, last + 1) : history.Run(first, last + 1)) {
+        waitSeconds += chrono::duration<double>(chrono::steady_clock::now() - waitStart).count();
+        exporter.Submit(generation.number, generation.frame);
+        waitStart = chrono::steady_clock::now();
+    }
+    auto stats = exporter.Finish();
+    auto seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << "Frames:       " << stats.frames << " (generations " << first << " -> " << last << ") on " << settings.threads << " encoding threads\n"
+        << "Bytes:        " << stats.bytes << '\n'
+        << "Seconds:      " << seconds << " (" << (seconds > 0 ? stats.frames / seconds : 0.0) << " frames/s)\n"
+        << "Frame waits:  " << waitSeconds << " s\n"
+        << "Queue stalls: " << stats.stallSeconds << " s\n";
+    return 0;
+}
+
+// Decode an animated GIF as written by FRAME_EXPORTER, refusing anything a strict decoder would refuse
+// Returns the palette index of every pixel of each frame, row by row
+// Codes widen when the decoder's next table entry reaches 2^codeSize, the rule every common decoder follows
+vector<vector<uint8_t>> DecodeGif(const vector<uint8_t>& file) {
+    static constexpr auto maxEntries = 4096u;
+    auto position = size_t{ 0 };
+    auto next = [&file, &position]() -> unsigned int {
+        if (position >= file.size()) { throw runtime_error{ "GIF ends early." }; }
+        return file[position++];
+    };
+    auto next16 = [&next] { auto low = next(); return low | next() << 8; };
+    auto subBlocks = [&next, &file, &position] {
+        auto data = vector<uint8_t>{ };
+        for (auto size = next(); size != 0; size = next()) {
+            if (position + size > file.size()) { throw runtime_error{ "GIF ends inside a data sub-block." }; }
+            data.insert(data.end(), file.begin() + position, file.begin() + position + size);
+            position += size;
+        }
+        return data;
+    };
+
+    if (file.size() < 13 || !equal(file.begin(), file.begin() + 6, "GIF89a")) { throw runtime_error{ "Not a GIF89a file." }; }
+    position = 6;
+    auto width = next16();
+    auto height = next16();
+    auto flags = next();
+    position += 2;
+    if (flags & 0x80u) { position += 3u << ((flags & 7u) + 1); }
+
+    auto frames = vector<vector<uint8_t>>{ };
+    for (auto introducer = next(); introducer != 0x3b; introducer = next()) {
+        if (introducer == 0x21) {
+            next();
+            subBlocks();
+            continue;
+        }
+        if (introducer != 0x2c) { throw runtime_error{ "Unknown GIF block " + to_string(introducer) }; }
+        position += 4;
+        if (next16() != width || next16() != height) { throw runtime_error{ "GIF frame is not the size of the screen." }; }
+        if (next() != 0) { throw runtime_error{ "GIF frame has a local color table or is interlaced." }; }
+        auto minimumCodeSize = next();
+        if (minimumCodeSize < 2 || minimumCodeSize > 8) { throw runtime_error{ "Bad LZW minimum code size." }; }
+        auto data = subBlocks();
+
+        auto clearCode = 1u << minimumCodeSize;
+        auto endCode = clearCode + 1;
+        auto prefixes = vector<uint16_t>(maxEntries);
+        auto suffixes = vector<uint8_t>(maxEntries);
+        auto lengths = vector<uint16_t>(maxEntries);
+        for (auto code = 0u; code < clearCode; ++code) { suffixes[code] = static_cast<uint8_t>(code); lengths[code] = 1; }
+
+        auto pixels = vector<uint8_t>{ };
+        auto bitPosition = size_t{ 0 };
+        auto codeSize = minimumCodeSize + 1;
+        auto nextEntry = endCode + 1;
+        auto previous = clearCode;                  // None since the last clear code
+        auto frameNumber = to_string(frames.size());
+        for (;;) {
+            if (bitPosition + codeSize > data.size() * 8) { throw runtime_error{ "LZW data of frame " + frameNumber + " ends before the end code." }; }
+            auto code = 0u;
+            for (auto bit = 0u; bit < codeSize; ++bit, ++bitPosition) { code |= ((data[bitPosition / 8] >> (bitPosition % 8)) & 1u) << bit; }
+            if (code == clearCode) {
+                codeSize = minimumCodeSize + 1;
+                nextEntry = endCode + 1;
+                previous = clearCode;
+                continue;
+            }
+            if (code == endCode) { break; }
+            if (code > nextEntry || (previous == clearCode && code > endCode)) {
+                throw runtime_error{ "Bad LZW code " + to_string(code) + " in frame " + frameNumber };
+            }
+
+            // A code one past the table is the previous string plus its own first pixel
+            auto expand = [&](unsigned int entry, size_t at) {
+                for (auto i = lengths[entry]; i > 0; --i, entry = prefixes[entry]) { pixels[at + i - 1] = suffixes[entry]; }
+            };
+            auto start = pixels.size();
+            if (code < nextEntry) {
+                pixels.resize(start + lengths[code]);
+                expand(code, start);
+            }
+            else {
+                pixels.resize(start + lengths[previous] + 1);
+                expand(previous, start);
+                pixels.back() = pixels[start];
+            }
+            if (previous != clearCode && nextEntry < maxEntries) {
+                prefixes[nextEntry] = static_cast<uint16_t>(previous);
+                suffixes[nextEntry] = pixels[start];
+                lengths[nextEntry] = static_cast<uint16_t>(lengths[previous] + 1);
+                if (++nextEntry == (1u << codeSize) && codeSize < 12) { ++codeSize; }
+            }
+            previous = code;
+        }
+        if ((bitPosition + 7) / 8 != data.size()) { throw runtime_error{ "LZW data of frame " + frameNumber + " continues past the end code." }; }
+        if (pixels.size() != static_cast<size_t>(width) * height) { throw runtime_error{ "Frame " + frameNumber + " has the wrong number of pixels." }; }
+        frames.push_back(move(pixels));
+    }
+    return frames;
+}
+
+// Export a soup as GIFs at several scales, then decode each file strictly & compare every pixel with its generation
+int GifCommand(const vector<string>& arguments) {
+    if (arguments.empty()) { throw invalid_argument{ "gif requires a generation count." }; }
+    auto generations = static_cast<size_t>(stoull(arguments[0]));
+    auto history = LIFE_HISTORY{ ParseBoardSize(arguments, 1) };
+    SeedSoup(history);
+    history.Advance(generations);
+    auto size = history.Size();
+
+    auto failed = false;
+    for (auto scale : { 1u, 2u, 3u, 6u, 11u }) {
+        auto settings = EXPORT_SETTINGS{ };
+        settings.path = filesystem::temp_directory_path() / ("Kata-Game-of-Life-gif-check-" + to_string(scale) + ".gif");
+        settings.scale = scale;
+        settings.threads = max<size_t>(THREAD_POOL::DefaultThreadCount(), 2) - 1;
+        auto exporter = FRAME_EXPORTER{ settings };
+        for (const auto& generation : history.Run(0, generations + 1)) { exporter.Submit(generation.number, generation.frame); }
+        auto stats = exporter.Finish();
+
+        auto stream = ifstream{ settings.path, ios::binary };
+        auto file = vector<uint8_t>(istreambuf_iterator<char>{ stream }, istreambuf_iterator<char>{ });
+        stream.close();
+        filesystem::remove(settings.path);
+
+        cout << "Scale " << setw(2) << scale << ": " << stats.frames << " frames, " << stats.bytes << " bytes: ";
+        auto frames = vector<vector<uint8_t>>{ };
+        try { frames = DecodeGif(file); }
+        catch (const runtime_error& error) {
+            cout << "MISMATCH: " << error.what() << '\n';
+            failed = true;
+            continue;
+        }
+        if (frames.size() != generations + 1) {
+            cout << "MISMATCH: decoded " << frames.size() << " frames\n";
+            failed = true;
+            continue;
+        }
+        auto difference = optional<pair<size_t, CELL_POSITION>>{ };
+        for (auto number = size_t{ 0 }; number < frames.size() && !difference; ++number) {
+            const auto& frame = history[number];
+            for (auto position : frame.Positions()) {
+                auto pixel = frames[number][(static_cast<size_t>(position.row) * size.width * scale + position.column) * scale];
+                if (pixel != static_cast<uint8_t>(frame.LifeState(position))) { difference = pair{ number, position }; break; }
+            }
+        }
+        if (difference) {
+            cout << "MISMATCH: generation " << difference->first << " differs at row " << difference->second.row << ", column " << difference->second.column << '\n';
+            failed = true;
+            continue;
+        }
+        cout << "decoded & matched\n";
+    }
+    if (failed) { return 1; }
+    cout << "Every GIF decodes strictly & matches its generations\n";
+    return 0;
+}
+
+constexpr auto zoomMapSide = size_t{ 32 };     // blocks drawn per side at most
+
+// Query the population pyramid of a simulated soup: random rectangles are counted from the pyramid & by visiting every cell
+// Then the coarsest level with few enough blocks is drawn as a density map, the way a zoomed-out view would read it
+int ZoomCommand(const vector<string>& arguments) {
+    if (arguments.size() < 2) { throw invalid_argument{ "zoom requires a generation count and a query count." }; }
+    auto generations = static_cast<size_t>(stoull(arguments[0]));
+    auto queries = static_cast<size_t>(stoull(arguments[1]));
+    auto size = ParseBoardSize(arguments, 2);
+
+    auto history = LIFE_HISTORY{ size };
+    SeedSoup(history);
+    history.Advance(generations);
+    const auto& frame = history[history.Generation()];
+
+    auto bits = uint64_t{ 0x2545f4914f6cdd1dull };
+    auto next = [&bits](unsigned int bound) {
+        bits ^= bits << 13;
+        bits ^= bits >> 7;
+        bits ^= bits << 17;
+        return static_cast<unsigned int>(bits % (static_cast<uint64_t>(bound) + 1));
+    };
+    auto regions = vector<CELL_REGION>(queries);
+    for (auto& region : regions) {
+        auto top = next(size.height), bottom = next(size.height);
+        auto left = next(size.width), right = next(size.width);
+        region = CELL_REGION{ CELL_POSITION{ min(top, bottom), min(left, right) }, CELL_POSITION{ max(top, bottom), max(left, right) } };
+    }
+
+    auto pyramidCounts = vector<uint64_t>(queries);
+    auto start = chrono::steady_clock::now();
+    for (auto i = size_t{ 0 }; i < queries; ++i) { pyramidCounts[i] = frame.LiveCellsIn(regions[i]); }
+    auto pyramidSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    auto mismatches = size_t{ 0 };
+    start = chrono::steady_clock::now();
+    for (auto i = size_t{ 0 }; i < queries; ++i) {
+        auto count = uint64_t{ 0 };
+        for (auto row = regions[i].first.row; row < regions[i].end.row; ++row) {
+            for (auto column = regions[i].first.column; column < regions[i].end.column; ++column) {
+                count += RYANS_UTILITIES::EnumHasFlag(frame.LifeState(CELL_POSITION{ row, column }), LIFE_STATE::ALIVE) ? 1u : 0u;
+            }
+        }
+        mismatches += count != pyramidCounts[i] ? 1u : 0u;
+    }
+    auto scanSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    const auto& pyramid = frame.Pyramid();
+    auto level = size_t{ 0 };
+    while (level + 1 < pyramid.Levels() && max(pyramid.LevelSize(level).width, pyramid.LevelSize(level).height) > zoomMapSide) { ++level; }
+    auto blocks = pyramid.LevelSize(level);
+    auto blockCells = static_cast<double>(POPULATION_PYRAMID::BlockSide(level) * POPULATION_PYRAMID::BlockSide(level));
+    cout << "Board:        " << size.width << 'x' << size.height << " at generation " << history.Generation() << '\n'
+        << "Population:   " << frame.Population() << '\n'
+        << "Levels:       " << pyramid.Levels() << ", drawing level " << level << " (" << blocks.width << 'x' << blocks.height << " blocks of "
+        << POPULATION_PYRAMID::BlockSide(level) << " cells a side)\n";
+    const auto shades = string{ " .:-=+*#%@" };
+    for (auto row = 0u; row < blocks.height; ++row) {
+        for (auto column = 0u; column < blocks.width; ++column) {
+            auto density = pyramid.Count(level, CELL_POSITION{ row, column }) / blockCells;
+            cout << shades[min(shades.size() - 1, static_cast<size_t>(density * 2 * shades.size()))];
+        }
+        cout << '\n';
+    }
+    cout << "Pyramid:      " << pyramidSeconds << " s (" << (queries > 0 ? pyramidSeconds * 1e6 / queries : 0.0) << " us/query)\n"
+        << "Cell scan:    " << scanSeconds << " s (" << (queries > 0 ? scanSeconds * 1e6 / queries : 0.0) << " us/query)\n";
+    if (mismatches > 0) {
+        cout << "MISMATCH: " << mismatches << " of " << queries << " regions differ from a cell by cell count\n";
+        return 1;
+    }
+    cout << "All regions match a cell by cell count\n";
+    return 0;
+}
+
+constexpr auto youngSoupGeneration = size_t{ 16 };
+constexpr auto youngSoupSteps = size_t{ 4 };
+
+// Whether two censuses list the same objects, cell for cell & with the same classification
+bool SameCensus(const OBJECT_CENSUS& expected, const OBJECT_CENSUS& actual) {
+    if (expected.Objects().size() != actual.Objects().size()) { return false; }
+    for (auto i = size_t{ 0 }; i < expected.Objects().size(); ++i) {
+        const auto& a = expected.Objects()[i];
+        const auto& b = actual.Objects()[i];
+        auto sameCells = equal(a.cells.begin(), a.cells.end(), b.cells.begin(), b.cells.end(), [](CELL_POSITION x, CELL_POSITION y) { return x.row == y.row && x.column == y.column; });
+        if (!sameCells || a.shape != b.shape || a.type.kind != b.type.kind || a.type.period != b.type.period) { return false; }
+    }
+    return true;
+}
+
+// List the objects of a soup after some generations, updating the census incrementally on the way
+// A young soup is updated one generation at a time while its debris moves across block boundaries,
+// then the settled soup one generation (so oscillators change phase) & two generations later
+// Every incremental update is checked against a census taken from scratch on the same frame
+int CensusCommand(const vector<string>& arguments) {
+    if (arguments.empty()) { throw invalid_argument{ "census requires a generation count." }; }
+    auto generations = static_cast<size_t>(stoull(arguments[0]));
+    auto size = ParseBoardSize(arguments, 1);
+
+    auto time = [](auto&& work) {
+        auto start = chrono::steady_clock::now();
+        work();
+        return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    };
+    auto history = LIFE_HISTORY{ size };
+    SeedSoup(history);
+    auto census = OBJECT_CENSUS{ };
+    auto mismatches = vector<size_t>{ };        // Generations
+    auto update = [&](const char* name, size_t steps) {
+        history.Advance(steps);
+        const auto& frame = history[history.Generation()];
+        auto seconds = time([&] { census.Update(frame); });
+        auto stats = census.Stats();
+        cout << left << setw(14) << name << right << seconds << " s at generation " << history.Generation() << " (" << stats.kept << " objects kept, " << stats.found << " found, "
+            << stats.blocksRescanned << " blocks rescanned, " << stats.shapesClassified << " shapes classified)\n";
+
+        auto fresh = OBJECT_CENSUS{ };
+        fresh.Update(frame);
+        if (!SameCensus(fresh, census)) { mismatches.push_back(history.Generation()); }
+    };
+
+    cout << "Board:        " << size.width << 'x' << size.height << '\n';
+    auto young = min(generations, youngSoupGeneration);
+    update("Young soup:", young);
+    for (auto i = size_t{ 0 }; i < youngSoupSteps; ++i) { update("  +1:", 1); }
+    update("Settled:", generations - min(generations, young + youngSoupSteps));
+    update("  +1:", 1);
+    update("  +2:", 2);
+
+    auto tally = vector<pair<size_t, string>>{ };
+    for (const auto& [label, count] : census.Tally()) { tally.emplace_back(count, label); }
+    sort(tally.begin(), tally.end(), [](const auto& a, const auto& b) { return a.first != b.first ? a.first > b.first : a.second < b.second; });
+    cout << "Objects:      " << census.Objects().size() << " at generation " << history.Generation() << '\n';
+    for (const auto& [count, label] : tally) { cout << "  " << setw(8) << count << ' ' << label << '\n'; }
+
+    if (!mismatches.empty()) {
+        cout << "MISMATCH: the incremental census differs from one taken from scratch at generation " << mismatches.front()
+            << " (" << mismatches.size() << " updates in all)\n";
+        return 1;
+    }
+    cout << "Every incremental census matches one taken from scratch\n";
+    return 0;
+}
+
+// Step the same soup with heap frames on a shared pool, then with first-touch frames on a pinned pool, with & without huge pages
+// Each run reports the cell throughput of the threads on every NUMA node, & all must end on the same generation
+int NumaCommand(const vector<string>& arguments) {
+    if (arguments.empty()) { throw invalid_argument{ "numa requires a generation count." }; }
+    auto generations = static_cast<size_t>(stoull(arguments[0]));
+    auto size = ParseBoardSize(arguments, 1);
+
+    const auto placements = array<pair<const char*, MEMORY_PLACEMENT>, 3>{ {
+        { "Heap:", MEMORY_PLACEMENT{ } },
+        { "First touch:", MEMORY_PLACEMENT{ true, false } },
+        { "Huge pages:", MEMORY_PLACEMENT{ true, true } }
+    } };
+    cout << "Board:        " << size.width << 'x' << size.height << " on " << THREAD_POOL::NodeCount() << " NUMA nodes\n";
+    auto hashes = vector<uint64_t>{ };
+    for (const auto& [name, placement] : placements) {
+        auto history = LIFE_HISTORY{ size };
+        history.Placement(placement);
+        SeedSoup(history);
+        auto start = chrono::steady_clock::now();
+        for (auto i = size_t{ 0 }; i < generations; ++i) { history.Advance(); }
+        auto seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        hashes.push_back(history[history.Generation()].Hash());
+
+        cout << left << setw(14) << name << right << seconds << " s (" << seconds * 1e9 / (static_cast<double>(size.CellCount()) * generations) << " ns/cell)\n";
+        auto stats = history.NodeStats();
+        for (auto node = size_t{ 0 }; node < stats.size(); ++node) {
+            if (stats[node].cells == 0) { continue; }
+            cout << "  node " << setw(3) << node << ' ' << setw(14) << stats[node].cells << " cells in " << stats[node].seconds << " thread s ("
+                << stats[node].cells / max(stats[node].seconds, 1e-9) / 1e6 << " Mcells/s per thread)\n";
+        }
+    }
+    if (adjacent_find(hashes.begin(), hashes.end(), not_equal_to<>{ }) != hashes.end()) {
+        cout << "MISMATCH: the placements did not all reach the same generation\n";
+        return 1;
+    }
+    cout << "Final generations match\n";
+    return 0;
+}
+
+// Starting boards for the conformance harness
+struct CONFORMANCE_SCENARIO {
+    string name{ };
+    BOARD_SIZE size{ };
+    function<void(TIME_SLICE&)> seed{ };
+};
+
+// Pattern given as rows of 'O' (alive) & '.' (dead), clipped to the board
+void PlacePattern(TIME_SLICE& frame, const vector<string>& rows, CELL_POSITION origin) {
+    for (auto row = size_t{ 0 }; row < rows.size(); ++row) {
+        for (auto column = size_t{ 0 }; column < rows[row].size(); ++column) {
+            auto position = CELL_POSITION{ origin.row + static_cast<unsigned int>(row), origin.column + static_cast<unsigned int>(column) };
+            if (rows[row][column] == 'O' && frame.Size().Contains(position)) { frame[position].TogleDeadAlive(); }
+        }
+    }
+}
+
+// Canonical patterns centred on each board, a glider run into the corner to exercise the edges, & random soups
+// The GUI board is the one size the FIXED engine runs at, while the sweep engines tile both sizes across the pool
+vector<CONFORMANCE_SCENARIO> ConformanceScenarios(BOARD_SIZE large, uint64_t seed) {
+    const auto glider = vector<string>{ ".O.", "..O", "OOO" };
+    const auto rPentomino = vector<string>{ ".OO", "OO.", ".O." };
+    const auto acorn = vector<string>{ ".O.....", "...O...", "OO..OOO" };
+    const auto gosperGun = vector<string>{
+        "........................O...........",
+        "......................O.O...........",
+        "............OO......OO............OO",
+        "...........O...O....OO............OO",
+        "OO........O.....O...OO..............",
+        "OO........O...O.OO....O.O...........",
+        "..........O.....O.......O...........",
+        "...........O...O....................",
+        "............OO......................"
+    };
+
+    auto scenarios = vector<CONFORMANCE_SCENARIO>{ };
+    for (auto size : { defaultBoardSize, large }) {
+        auto centred = [size](const vector<string>& rows) {
+            return CELL_POSITION{ (size.height - min<unsigned int>(size.height, static_cast<unsigned int>(rows.size()))) / 2,
+                (size.width - min<unsigned int>(size.width, static_cast<unsigned int>(rows[0].size()))) / 2 };
+        };
+        auto add = [&](string name, const vector<string>& rows, CELL_POSITION origin) {
+            scenarios.push_back(CONFORMANCE_SCENARIO{ move(name), size, [rows, origin](TIME_SLICE& frame) { PlacePattern(frame, rows, origin); } });
+        };
+        add("glider", glider, centred(glider));
+        add("glider into corner", glider, CELL_POSITION{ size.height - min(size.height, 6u), size.width - min(size.width, 6u) });
+        add("R-pentomino", rPentomino, centred(rPentomino));
+        add("acorn", acorn, centred(acorn));
+        if (size.width >= gosperGun[0].size() + 2 && size.height >= gosperGun.size() + 2) { add("Gosper glider gun", gosperGun, CELL_POSITION{ 1, 1 }); }
+
+        for (auto soup = uint64_t{ 0 }; soup < 2; ++soup) {
+            scenarios.push_back(CONFORMANCE_SCENARIO{ "soup " + to_string(seed + soup), size, [bits = (seed + soup) * 0x9e3779b97f4a7c15ull | 1](TIME_SLICE& frame) mutable {
+                for (auto position : frame.Positions()) {
+                    bits ^= bits << 13;
+                    bits ^= bits >> 7;
+                    bits ^= bits << 17;
+                    if (bits % 3 == 0) { frame[position].TogleDeadAlive(); }
+                }
+            } });
+        }
+    }
+    return scenarios;
+}
+
+// First cell whose state (every LIFE_STATE bit) or neighbor count differs, if any
+optional<CELL_POSITION> FirstDifference(const TIME_SLICE& expected, const TIME_SLICE& actual) {
+    for (auto position : expected.Positions()) {
+        if (expected.LifeState(position) != actual.LifeState(position) || expected.NeighborCount(position) != actual.NeighborCount(position)) { return position; }
+    }
+    return nullopt;
+}
+
+// Run every scenario through every engine & check each against the reference engine after every temporal block
+// Frames must agree cell for cell, including the WAS_ALIVE & WILL_LIVE history bits, as must populations & hashes
+// Throughput is reported per board size beside the check, so no engine's speed is read without its result
+// Off Windows the board is also split across worker processes, whose gathered board is loaded back as a frame after every block
+#ifndef _WIN32
+constexpr auto conformanceWorkers = size_t{ 3 };    // processes
+#endif // !_WIN32
+
+int ConformCommand(const vector<string>& arguments) {
+    if (arguments.empty()) { throw invalid_argument{ "conform requires a generation count." }; }
+    auto generations = static_cast<size_t>(stoull(arguments[0]));
+    auto seed = arguments.size() > 1 ? static_cast<uint64_t>(stoull(arguments[1])) : uint64_t{ 1 };
+    auto large = arguments.size() > 2 ? ParseBoardSize(arguments, 2) : BOARD_SIZE{ 320, 200 };
+
+    enum ENGINE_ID {
+        REFERENCE, SWEEP, TEMPORAL, FIXED,
+#ifndef _WIN32
+        DISTRIBUTED,
+#endif // !_WIN32
+        ENGINE_COUNT
+    };
+    const auto engineNames = array<const char*, ENGINE_COUNT>{
+        "reference", "sweep", "temporal", "fixed",
+#ifndef _WIN32
+        "distributed",
+#endif // !_WIN32
+    };
+    struct THROUGHPUT {
+        double cells{ 0.0 };                            // Per engine
+        array<double, ENGINE_COUNT> seconds{ };
+    };
+    auto throughput = map<pair<unsigned int, unsigned int>, THROUGHPUT>{ };     // By board width & height
+    auto time = [](auto&& work) {
+        auto start = chrono::steady_clock::now();
+        work();
+        return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    };
+
+    auto pool = make_shared<THREAD_POOL>();
+    auto checks = size_t{ 0 };
+    auto mismatches = size_t{ 0 };
+    cout << left << setw(22) << "Scenario" << setw(10) << "Board" << setw(12) << "Population" << "Hash\n";
+    for (const auto& scenario : ConformanceScenarios(large, seed)) {
+        auto start = TIME_SLICE{ scenario.size };
+        scenario.seed(start);
+        auto histories = array<LIFE_HISTORY, FIXED>{ LIFE_HISTORY{ scenario.size, pool }, LIFE_HISTORY{ scenario.size, pool }, LIFE_HISTORY{ scenario.size, pool } };
+        histories[REFERENCE].Engine(LIFE_HISTORY::ENGINE::REFERENCE);
+        histories[SWEEP].FixedSizeKernel(false);      // The FIXED row checks that kernel, these the tiled sweep
+        histories[TEMPORAL].FixedSizeKernel(false);
+        for (auto& history : histories) { history.GetLatestGeneration() = start; }
+        auto fixedBoard = scenario.size == DEFAULT_FIXED_TIME_SLICE::size ? optional{ DEFAULT_FIXED_TIME_SLICE{ start } } : nullopt;
+#ifndef _WIN32
+        // Strips as tall as the halo allows, each advanced by its own worker process a whole block per exchange
+        auto workers = min<size_t>(conformanceWorkers, scenario.size.height);
+        auto halo = max(1u, min(static_cast<unsigned int>(histories[TEMPORAL].TemporalDepth()), scenario.size.height / static_cast<unsigned int>(workers)));
+        auto coordinator = STRIP_COORDINATOR::SpawnLocalWorkers(STRIP_COORDINATOR::Partition(scenario.size.width, scenario.size.height, workers, halo));
+        coordinator.Scatter([&start](CELL_POSITION position) { return (static_cast<uint8_t>(start.LifeState(position)) & static_cast<uint8_t>(LIFE_STATE::ALIVE)) != 0; });
+        auto gathered = optional<LIFE_HISTORY>{ };
+#endif // !_WIN32
+        auto& boardThroughput = throughput[{ scenario.size.width, scenario.size.height }];
+        boardThroughput.cells += static_cast<double>(scenario.size.CellCount()) * generations;
+        auto& boardSeconds = boardThroughput.seconds;
+        auto failed = array<bool, ENGINE_COUNT>{ };
+
+        for (auto generation = size_t{ 0 }; generation < generations; ) {
+            auto block = min(generations - generation, histories[TEMPORAL].TemporalDepth());
+            boardSeconds[REFERENCE] += time([&] { for (auto i = size_t{ 0 }; i < block; ++i) { histories[REFERENCE].Advance(); } });
+            boardSeconds[SWEEP] += time([&] { for (auto i = size_t{ 0 }; i < block; ++i) { histories[SWEEP].Advance(); } });
+            boardSeconds[TEMPORAL] += time([&] { histories[TEMPORAL].Advance(block); });
+            if (fixedBoard) { boardSeconds[FIXED] += time([&] { fixedBoard->Advance(block); }); }
+#ifndef _WIN32
+            boardSeconds[DISTRIBUTED] += time([&] { coordinator.Advance(block); });
+            auto snapshot = stringstream{ };
+            coordinator.Save(snapshot);
+            gathered = LIFE_HISTORY::Load(snapshot, pool);
+#endif // !_WIN32
+            generation += block;
+
+            const auto& expected = histories[REFERENCE][generation];
+            auto fixedFrame = fixedBoard ? optional{ fixedBoard->ToTimeSlice() } : nullopt;
+            for (auto engine = size_t{ SWEEP }; engine < ENGINE_COUNT; ++engine) {
+                if (failed[engine] || (engine == FIXED && !fixedBoard)) { continue; }
+                const auto* actualFrame = engine == FIXED ? &*fixedFrame : nullptr;
+#ifndef _WIN32
+                if (engine == DISTRIBUTED) { actualFrame = &(*gathered)[generation]; }
+#endif // !_WIN32
+                const auto& actual = actualFrame ? *actualFrame : histories[engine][generation];
+                ++checks;
+                auto difference = FirstDifference(expected, actual);
+                if (!difference && expected.Hash() == actual.Hash() && expected.Population() == actual.Population()) { continue; }
+
+                failed[engine] = true;
+                ++mismatches;
+                cout << "MISMATCH: " << engineNames[engine] << " differs from reference on " << scenario.name << ' ' << scenario.size.width << 'x' << scenario.size.height
+                    << " at generation " << generation << " (population " << actual.Population() << " vs " << expected.Population() << ')';
+                if (difference) {
+                    cout << ", first at row " << difference->row << " column " << difference->column
+                        << ": state " << static_cast<unsigned int>(actual.LifeState(*difference)) << " vs " << static_cast<unsigned int>(expected.LifeState(*difference))
+                        << ", neighbors " << actual.NeighborCount(*difference) << " vs " << expected.NeighborCount(*difference);
+                }
+                cout << '\n';
+            }
+        }
+
+        const auto& last = histories[REFERENCE][generations];
+        auto board = to_string(scenario.size.width) + 'x' + to_string(scenario.size.height);
+        cout << setw(22) << scenario.name << setw(10) << board << setw(12) << last.Population() << hex << last.Hash() << dec << '\n';
+    }
+
+    cout << "\n" << setw(10) << "Board" << setw(12) << "Engine" << right << setw(12) << "ns/cell" << setw(12) << "speedup" << left << '\n';
+    for (const auto& [board, boardThroughput] : throughput) {
+        const auto& engineSeconds = boardThroughput.seconds;
+        for (auto engine = size_t{ REFERENCE }; engine < ENGINE_COUNT; ++engine) {
+            if (engineSeconds[engine] == 0) { continue; }
+            cout << setw(10) << (to_string(board.first) + 'x' + to_string(board.second)) << setw(12) << engineNames[engine] << right << fixed << setprecision(3)
+                << setw(12) << engineSeconds[engine] * 1e9 / max(boardThroughput.cells, 1.0) << setw(11) << engineSeconds[REFERENCE] / engineSeconds[engine] << 'x' << defaultfloat << left << '\n';
+        }
+    }
+
+    if (mismatches > 0) {
+        cout << "MISMATCH: " << mismatches << " engine runs disagree with the reference engine\n";
+        return 1;
+    }
+    cout << "All engines match the reference engine at " << checks << " checked generations\n";
+    return 0;
+}
+
+constexpr auto heldFrameLimit = size_t{ 4 };      // per reader
+constexpr auto longestJump = size_t{ 64 };        // generations
+
+// Stress the lock-free read path: reader threads fetch random generations while the owner edits, publishes & advances
+// The owner replays every edit & step on a reference engine history too, noting each generation's hash before the real history publishes past it
+// A reader checks any generation older than the one published, as it can no longer change, & keeps a few frames to check they never change under it
+// Meant to run under ThreadSanitizer, which also sees whether that publication orders the noted hashes before the reads
+int ReadersCommand(const vector<string>& arguments) {
+    if (arguments.size() < 2) { throw invalid_argument{ "readers requires a thread count and a generation count." }; }
+    auto threadCount = max<size_t>(static_cast<size_t>(stoull(arguments[0])), 1);
+    auto generations = static_cast<size_t>(stoull(arguments[1]));
+    auto size = ParseBoardSize(arguments, 2);
+
+    auto history = LIFE_HISTORY{ size };
+    auto shadow = LIFE_HISTORY{ size };
+    shadow.Engine(LIFE_HISTORY::ENGINE::REFERENCE);
+    SeedSoup(history);
+    SeedSoup(shadow);
+    history.PublishLatest();
+    auto expected = vector<uint64_t>(generations + 1);     // Written by the owner only before publishing a later generation
+
+    struct RESULT {
+        size_t reads{ 0 };
+        size_t checked{ 0 };
+        size_t heldChecks{ 0 };
+        size_t mismatches{ 0 };
+        string firstMismatch{ };
+    };
+    auto results = vector<RESULT>(threadCount);
+    auto done = atomic<bool>{ false };
+    auto readers = vector<thread>{ };
+    for (auto i = size_t{ 0 }; i < threadCount; ++i) {
+        readers.emplace_back([&history, &expected, &done, &result = results[i], bits = (i + 1) * 0x9e3779b97f4a7c15ull] () mutable {
+            auto next = [&bits] {
+                bits ^= bits << 13;
+                bits ^= bits >> 7;
+                bits ^= bits << 17;
+                return bits;
+            };
+            auto fail = [&result](const string& what) {
+                if (result.mismatches++ == 0) { result.firstMismatch = what; }
+            };
+            auto reader = LIFE_HISTORY::READER{ history };
+            auto held = deque<pair<LIFE_HISTORY::FRAME_HANDLE, uint64_t>>{ };
+            auto lastPublished = size_t{ 0 };
+            while (!done.load(memory_order_acquire)) {
+                auto published = reader.Generation();
+                if (published < lastPublished) { fail("published generation went back from " + to_string(lastPublished) + " to " + to_string(published)); }
+                lastPublished = published;
+
+                // Half the reads follow the latest generation, like a viewer would, as that is the frame the owner may still edit
+                auto generation = next() % 2 == 0 ? published : static_cast<size_t>(next() % (published + 1));
+                auto frame = reader[generation];
+                auto hash = frame->Hash();
+                ++result.reads;
+                if (generation < published) {
+                    ++result.checked;
+                    if (hash != expected[generation]) { fail("generation " + to_string(generation) + " read with hash " + to_string(hash) + ", expected " + to_string(expected[generation])); }
+                }
+
+                held.emplace_back(move(frame), hash);
+                if (held.size() > heldFrameLimit || next() % 4 == 0) {
+                    ++result.heldChecks;
+                    if (held.front().first->Hash() != held.front().second) { fail("a held frame changed while a reader kept it"); }
+                    held.pop_front();
+                }
+            }
+        });
+    }
+
+    auto owner = [bits = uint64_t{ 0x2545f4914f6cdd1dull }] () mutable {
+        bits ^= bits << 13;
+        bits ^= bits >> 7;
+        bits ^= bits << 17;
+        return bits;
+    };
+    auto edits = size_t{ 0 };
+    auto steps = size_t{ 0 };
+    auto jumps = size_t{ 0 };
+    auto start = chrono::steady_clock::now();
+    while (history.Generation() < generations) {
+        auto choice = owner() % 8;
+        if (choice < 3) {
+            auto position = CELL_POSITION{ static_cast<unsigned int>(owner() % size.height), static_cast<unsigned int>(owner() % size.width) };
+            history.GetLatestGeneration()[position].TogleDeadAlive();
+            shadow.GetLatestGeneration()[position].TogleDeadAlive();
+            history.PublishLatest();
+            ++edits;
+            this_thread::yield();
+            continue;
+        }
+
+        // Every generation passed is noted from the reference history before the real one publishes its last
+        auto count = choice < 6 ? size_t{ 1 } : min<size_t>(2 + owner() % (longestJump - 1), generations - history.Generation());
+        expected[shadow.Generation()] = shadow[shadow.Generation()].Hash();
+        for (auto i = size_t{ 1 }; i < count; ++i) {
+            shadow.Advance();
+            expected[shadow.Generation()] = shadow[shadow.Generation()].Hash();
+        }
+        shadow.Advance();
+        if (count == 1) { history.Advance(); ++steps; }
+        else { history.Advance(count); ++jumps; }
+        this_thread::yield();           // Let readers in between operations even on a machine with few cores
+    }
+    expected[generations] = shadow[generations].Hash();
+    auto seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    done.store(true, memory_order_release);
+    for (auto& reader : readers) { reader.join(); }
+
+    auto total = RESULT{ };
+    for (const auto& result : results) {
+        total.reads += result.reads;
+        total.checked += result.checked;
+        total.heldChecks += result.heldChecks;
+        total.mismatches += result.mismatches;
+        if (total.firstMismatch.empty()) { total.firstMismatch = result.firstMismatch; }
+    }
+    if (history[generations].Hash() != expected[generations]) {
+        ++total.mismatches;
+        if (total.firstMismatch.empty()) { total.firstMismatch = "the final generation differs from the reference engine"; }
+    }
+    cout << "Board:        " << size.width << 'x' << size.height << " read by " << threadCount << " threads\n"
+        << "Owner:        " << edits << " edits, " << steps << " steps, " << jumps << " jumps to generation " << generations << " in " << seconds << " s\n"
+        << "Reads:        " << total.reads << " (" << total.checked << " checked against the reference engine)\n"
+        << "Held frames:  " << total.heldChecks << " rechecked\n";
+    if (total.mismatches > 0) {
+        cout << "MISMATCH: " << total.mismatches << " reads went wrong, first: " << total.firstMismatch << '\n';
+        return 1;
+    }
+    cout << "Every read matches the reference engine\n";
+    return 0;
+}
+
+#ifndef _WIN32
+constexpr auto inProcessCheckLimit = double{ 1 << 26 };     // cells
+
+// Run a soup split across local worker processes that trade halos over Unix domain sockets
+// Boards small enough to fit comfortably are also run in-process to check the result
+int DistributeCommand(const vector<string>& arguments) {
+    if (arguments.size() < 4) { throw invalid_argument{ "distribute requires a worker count, board width & height, and a generation count." }; }
+    auto workers = static_cast<size_t>(stoull(arguments[0]));
+    auto width = static_cast<unsigned int>(stoul(arguments[1]));
+    auto height = static_cast<unsigned int>(stoul(arguments[2]));
+    auto generations = static_cast<size_t>(stoull(arguments[3]));
+    auto halo = arguments.size() > 4 ? static_cast<unsigned int>(stoul(arguments[4])) : 8u;
+
+    auto coordinator = STRIP_COORDINATOR::SpawnLocalWorkers(STRIP_COORDINATOR::Partition(width, height, workers, halo));
+    coordinator.Scatter(SoupCellAlive);
+    auto start = chrono::steady_clock::now();
+    auto stats = coordinator.Advance(generations);
+    auto seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    auto population = uint64_t{ 0 };
+    for (auto i = size_t{ 0 }; i < stats.size(); ++i) {
+        population += stats[i].population;
+        cout << "Worker " << i << ":     " << stats[i].population << " alive, " << stats[i].exchanges << " exchanges, "
+            << stats[i].haloBytes << " halo bytes, " << stats[i].computeSeconds << " s computing, " << stats[i].exchangeSeconds << " s exchanging\n";
+    }
+    auto cells = static_cast<double>(width) * height * generations;
+    auto hash = coordinator.Hash();
+    cout << "Generation:   " << coordinator.Generation() << '\n'
+        << "Population:   " << population << '\n'
+        << "Seconds:      " << seconds << " (" << (cells > 0 ? seconds * 1e9 / cells : 0.0) << " ns/cell)\n"
+        << "Final hash:   " << hex << hash << dec << '\n';
+    if (arguments.size() > 5) {
+        RYANS_UTILITIES::WriteFileAtomically(arguments[5], [&](ostream& stream) { coordinator.Save(stream); });
+    }
+
+    if (static_cast<double>(width) * height > inProcessCheckLimit) {
+        cout << "Board too large to check in-process\n";
+        return 0;
+    }
+    auto history = LIFE_HISTORY{ BOARD_SIZE{ width, height } };
+    SeedSoup(history);
+    history.Advance(generations);
+    if (history[history.Generation()].Hash() != hash) {
+        cout << "MISMATCH: the distributed board differs from the in-process engine\n";
+        return 1;
+    }
+    cout << "Matches the in-process engine\n";
+    return 0;
+}
+
+// Stream a soup to viewers on this machine, optionally paced so that they can follow along
+int ServeCommand(const vector<string>& arguments) {
+    if (arguments.size() < 2) { throw invalid_argument{ "serve requires a port and a generation count." }; }
+    auto port = static_cast<uint16_t>(stoul(arguments[0]));
+    auto generations = static_cast<size_t>(stoull(arguments[1]));
+    auto rate = arguments.size() > 2 ? stod(arguments[2]) : 0.0;
+    auto size = ParseBoardSize(arguments, 3);
+
+    auto history = LIFE_HISTORY{ size };
+    SeedSoup(history);
+    auto reader = LIFE_HISTORY::READER{ history };
+    auto server = FRAME_STREAM_SERVER{ size, port };
+    cout << "Serving " << size.width << 'x' << size.height << " on 127.0.0.1:" << server.Port() << endl;
+
+    auto start = chrono::steady_clock::now();
+    server.Publish(0, reader[0]);
+    for (auto generation = size_t{ 1 }; generation <= generations; ++generation) {
+        history.Advance();
+        server.Publish(generation, reader[generation]);
+        if (rate > 0) { this_thread::sleep_until(start + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>{ generation / rate })); }
+    }
+    auto stats = server.Stats();
+    cout << "Generations:  " << generations << " in " << chrono::duration<double>(chrono::steady_clock::now() - start).count() << " s\n"
+        << "Clients:      " << stats.clients << " still connected\n"
+        << "Sent:         " << stats.keyframes << " keyframes, " << stats.deltas << " deltas, " << stats.bytes << " bytes\n"
+        << "Coalesced:    " << stats.generationsCoalesced << " generations\n";
+    return 0;
+}
+
+// Stream a soup to local test clients, each checking every frame it receives against the history
+// Clients watch different viewports at different rates, & the last one reads slowly to exercise coalescing
+int StreamCommand(const vector<string>& arguments) {
+    if (arguments.size() < 2) { throw invalid_argument{ "stream requires a client count and a generation count." }; }
+    auto clientCount = static_cast<size_t>(stoull(arguments[0]));
+    auto generations = static_cast<size_t>(stoull(arguments[1]));
+    auto size = ParseBoardSize(arguments, 2);
+
+    auto history = LIFE_HISTORY{ size };
+    SeedSoup(history);
+    auto reader = LIFE_HISTORY::READER{ history };
+    auto server = FRAME_STREAM_SERVER{ size };
+    server.Publish(0, reader[0]);
+
+    struct RESULT {
+        CELL_REGION viewport{ };
+        unsigned int framesPerSecond{ 0 };
+        bool slow{ false };
+        STREAM_CLIENT_STATS stats{ };
+        size_t finalGeneration{ 0 };
+        size_t mismatches{ 0 };
+        string error{ };
+    };
+    auto results = vector<RESULT>(clientCount);
+    auto clients = vector<thread>{ };
+    for (auto i = size_t{ 0 }; i < clientCount; ++i) {
+        auto& result = results[i];
+        if (i > 0) {
+            auto first = CELL_POSITION{ static_cast<unsigned int>(size.height * i / (2 * clientCount)), static_cast<unsigned int>(size.width * i / (2 * clientCount)) };
+            result.viewport = CELL_REGION{ first, CELL_POSITION{ first.row + (size.height + 1) / 2, first.column + (size.width + 1) / 2 } };
+        }
+        else { result.viewport = CELL_REGION{ CELL_POSITION{ }, CELL_POSITION{ size.height, size.width } }; }
+        result.framesPerSecond = i % 3 == 1 ? 30 : 0;
+        result.slow = clientCount > 1 && i == clientCount - 1;
+        clients.emplace_back([&history, &result, generations, port = server.Port()] {
+            try {
+                auto client = FRAME_STREAM_CLIENT{ port };
+                auto check = LIFE_HISTORY::READER{ history };
+                client.Subscribe(result.viewport, result.framesPerSecond);
+                while (client.Receive()) {
+                    const auto viewport = client.Viewport();
+                    auto frame = check[client.Generation()];
+                    for (auto row = viewport.first.row; row < viewport.end.row; ++row) {
+                        for (auto column = viewport.first.column; column < viewport.end.column; ++column) {
+                            result.mismatches += client.LifeState(CELL_POSITION{ row, column }) != frame->LifeState(CELL_POSITION{ row, column }) ? 1u : 0u;
+                        }
+                    }
+                    if (client.Generation() == generations) { break; }
+                    if (result.slow) { this_thread::sleep_for(chrono::milliseconds{ 5 }); }
+                }
+                result.stats = client.Stats();
+                result.finalGeneration = client.Generation();
+            }
+            catch (const exception& error) { result.error = error.what(); }
+        });
+    }
+
+    auto start = chrono::steady_clock::now();
+    for (auto generation = size_t{ 1 }; generation <= generations; ++generation) {
+        history.Advance();
+        server.Publish(generation, reader[generation]);
+    }
+    auto simulationSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    for (auto& client : clients) { client.join(); }
+
+    auto failed = false;
+    for (auto i = size_t{ 0 }; i < clientCount; ++i) {
+        const auto& result = results[i];
+        auto cells = static_cast<double>(result.viewport.Height()) * result.viewport.Width();
+        auto frames = result.stats.keyframes + result.stats.deltas;
+        cout << "Client " << i << ":     " << result.viewport.Width() << 'x' << result.viewport.Height() << " at "
+            << (result.framesPerSecond > 0 ? to_string(result.framesPerSecond) + " fps" : string{ "every generation" }) << (result.slow ? ", slow reader" : "") << ": "
+            << frames << " frames, " << result.stats.bytes << " bytes (" << (frames > 0 ? result.stats.bytes / (frames * cells) : 0.0) << " bytes/cell/frame)\n";
+        if (!result.error.empty()) { cout << "  ERROR: " << result.error << '\n'; }
+        failed = failed || !result.error.empty() || result.mismatches > 0 || result.finalGeneration != generations;
+    }
+    auto stats = server.Stats();
+    cout << "Simulating:   " << simulationSeconds << " s for " << generations << " generations\n"
+        << "Sent:         " << stats.keyframes << " keyframes, " << stats.deltas << " deltas, " << stats.bytes << " bytes\n"
+        << "Coalesced:    " << stats.generationsCoalesced << " generations\n";
+    if (failed) {
+        cout << "MISMATCH: a client's frames differ from the history or stopped short of the last generation\n";
+        return 1;
+    }
+    cout << "Every client's frames match the history\n";
+    return 0;
+}
+#endif // !_WIN32
+
+int main(int argc, char* argv[]) {
+    const auto commands = map<string, int(*)(const vector<string>&)>{
+        { "replay", ReplayCommand },
+        { "record", RecordCommand },
+        { "jump", JumpCommand },
+        { "batch", BatchCommand },
+        { "kernel", KernelCommand },
+        { "export", ExportCommand },
+        { "gif", GifCommand },
+        { "zoom", ZoomCommand },
+        { "census", CensusCommand },
+        { "numa", NumaCommand },
+        { "conform", ConformCommand },
+        { "readers", ReadersCommand },
+#ifndef _WIN32
+        { "distribute", DistributeCommand },
+        { "serve", ServeCommand },
+        { "stream", StreamCommand },
+#endif // !_WIN32
+    };
+
+    auto arguments = vector<string>(argv + min(argc, 2), argv + argc);
+    auto command = argc > 1 ? commands.find(argv[1]) : commands.end();
+    if (command == commands.end()) {
+        cerr << "Usage: Kata-Game-of-Life-Headless replay <log file> [reference|sweep]\n"
+            << "       Kata-Game-of-Life-Headless record <log file> <generations> [width height]\n"
+            << "       Kata-Game-of-Life-Headless jump <generations> [temporal depth] [width height]\n"
+            << "       Kata-Game-of-Life-Headless batch <boards> <generations>\n"
+            << "       Kata-Game-of-Life-Headless kernel <generations> [width height]\n"
+            << "       Kata-Game-of-Life-Headless export <gif|png> <output> <generations> [simple|extended] [scale] [session file]\n"
+            << "       Kata-Game-of-Life-Headless gif <generations> [width height]\n"
+            << "       Kata-Game-of-Life-Headless zoom <generations> <queries> [width height]\n"
+            << "       Kata-Game-of-Life-Headless census <generations> [width height]\n"
+            << "       Kata-Game-of-Life-Headless numa <generations> [width height]\n"
+            << "       Kata-Game-of-Life-Headless conform <generations> [seed] [width height]\n"
+            << "       Kata-Game-of-Life-Headless readers <threads> <generations> [width height]\n"
+            << "       Kata-Game-of-Life-Headless distribute <workers> <width> <height> <generations> [halo depth] [snapshot file]\n"
+            << "       Kata-Game-of-Life-Headless serve <port> <generations> [generations per second] [width height]\n"
+            << "       Kata-Game-of-Life-Headless stream <clients> <generations> [width height]\n";
+        return 2;
+    }
+
+    try { return command->second(arguments); }
+    catch (const exception& error) {
+        cerr << error.what() << '\n';
+        return 2;
+    }
+}
@@ -1,88 +1,162 @@
 #include "Kata-Game-of-Life.h"
 
+// Brushes for every life state, painted from one of the shared palettes
+static map<LIFE_STATE, HBRUSH> CreateBrushes(const LIFE_PALETTE& palette) {
+    auto brushes = map<LIFE_STATE, HBRUSH>{ };
+    for (auto index = size_t{ 0 }; index < palette.size(); ++index) {
+        auto state = static_cast<LIFE_STATE>(index);
+        auto color = PaletteColor(palette, state);
+        brushes[state] = CreateSolidBrush(RGB(color.red, color.green, color.blue));
+    }
+    return brushes;
+}
+
 void InitializeGame(HWND hFrame) {
     g_hWnd = hFrame;
-    g_table.InitializeTable();
-    for (auto& position : allPositions) {
-        allCells.push_back(WINDOW{ WINDOWS_TABLE::CELL_ID{ position } });
+    auto& session = *new GAME_SESSION{ };
+    SetWindowLongPtr(hFrame, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(&session));
+    session.simpleBrushes = CreateBrushes(simplePalette);
+    session.extendedBrushes = CreateBrushes(extendedPalette);
+    session.table.InitializeTable(session.history.Size());
+    for (auto position : ALL_CELL_POSITIONS{ session.history.Size() }) {
+        session.cells.push_back(WINDOW{ WINDOWS_TABLE::CELL_ID{ position } });
     }
     auto pos = WINDOW_POSITION{ 650 , 0 };
     auto size = WINDOW_DIMENSIONS{ 100 , 25 };
-    playPauseDisplay = ConstructChildWindow("static", hFrame, ID_PLAY_PAUSE, pos, size).Text("Pause");
+    session.playPauseDisplay = ConstructChildWindow("static", hFrame, ID_PLAY_PAUSE, pos, size).Text("Pause");
     pos.y += size.height;
-    generationNumDisplay = ConstructChildWindow("static", hFrame, ID_GENERATION_LABEL, pos, size).Text("0");
+    session.generationNumDisplay = ConstructChildWindow("static", hFrame, ID_GENERATION_LABEL, pos, size).Text("0");
     pos.y += size.height;
     size.width = 200;
-    buttonToggleExtendedBrushes = ConstructChildWindow("button", hFrame, IDC_TOGGLE_EXTENDED, pos, size).Text("Toggle extra colors");
+    session.buttonToggleExtendedBrushes = ConstructChildWindow("button", hFrame, IDC_TOGGLE_EXTENDED, pos, size).Text("Toggle extra colors");
+    StartReplayLog(session);
+}
+
+// Record edits & steps from the current latest generation onward so the session can be replayed headless
+void StartReplayLog(GAME_SESSION& session) {
+    try { session.replayLog.Start(session.replayPath, session.history); }
+    catch (const exception&) { session.replayLog.Stop(); }      // Recording is best-effort and never blocks play
 }
 
-void TogglePause() {
-    pause = !pause;
-    playPauseDisplay.Text(pause ? "Pause" : "Play");
-    if (pause) { WINDOW{ g_hWnd }.Redraw(); }
+void TogglePause(GAME_SESSION& session) {
+    session.pause = !session.pause;
+    session.playPauseDisplay.Text(session.pause ? "Pause" : "Play");
+    if (session.pause) { WINDOW{ g_hWnd }.Redraw(); }
 }
 
 // Move display forward/backward through generations
 // Advancing past the end calculates one new generation and displays that one
-void StepGeneration(int step) {
+void StepGeneration(GAME_SESSION& session, int step) {
+    auto& history = session.history;
+    auto& generationIndex = session.generationIndex;
     if (step == 0) { throw invalid_argument{ "A step size of zero is trivial." }; }
     else if (step > 0 && generationIndex == history.Generation()) {
         history.Advance();
+        session.replayLog.RecordAdvance(history);
         ++generationIndex;
+        if (generationIndex % autosaveInterval == 0) { SaveSession(session); }   // Guard long runs against being cut short
     }
     else if (step > 0 && generationIndex < history.Generation()) { generationIndex += step; }
-    else if (abs(step) > generationIndex) { generationIndex = 0; }
+    else if (generationIndex < history.FirstGeneration() + abs(step)) { generationIndex = history.FirstGeneration(); }
     else { generationIndex += step; }
 
     auto msg = to_wstring(generationIndex);
     if (generationIndex < history.Generation()) { msg = L"**"s + msg + L"**"s; }
-    generationNumDisplay.Wtext(msg);
-    for (auto& cell : allCells) { cell.Redraw(); }
+    session.generationNumDisplay.Wtext(msg);
+    for (auto& cell : session.cells) { cell.Redraw(); }
+    history.Prefetch(generationIndex, step);    // Ready the next few frames in the scrub direction
 }
 
 // Timer to space out step forward messages, lest the queue saturate and crowd out other input
 void ResetTimer(HWND hFrame) { SetTimer(hFrame, timerId, timeIncrement, (TIMERPROC)NULL); }
 
-void ToggleExtendedBrushes(HWND hFrame) {
-    useExtendedBrushes = !useExtendedBrushes;
+void ToggleExtendedBrushes(GAME_SESSION& session, HWND hFrame) {
+    session.useExtendedBrushes = !session.useExtendedBrushes;
     WINDOW{ hFrame }.Redraw().Focus();
 }
 
 void CleanupGameResources(HWND hFrame) {
-    for (auto& brushPair : extendedBrushes) { DeleteObject(brushPair.second); }
-    for (auto& brushPair : simpleBrushes) { DeleteObject(brushPair.second); }
     KillTimer(hFrame, timerId);
+    auto* session = GetGameSession(hFrame);
+    if (session == nullptr) { return; }
+    SetWindowLongPtr(hFrame, GWLP_USERDATA, 0);
+    for (auto& brushPair : session->extendedBrushes) { DeleteObject(brushPair.second); }
+    for (auto& brushPair : session->simpleBrushes) { DeleteObject(brushPair.second); }
+    delete session;
 }
 
-void CheckTimer(HWND hFrame) {
+void CheckTimer(GAME_SESSION& session, HWND hFrame) {
     auto msg = MSG{ };
     PeekMessage(&msg, hFrame, WM_TIMER, WM_TIMER, PM_REMOVE);
     if (msg.message == WM_TIMER) {
-        if (!pause) { SendMessage(hFrame, WM_COMMAND, MAKEWPARAM(WM_ADVANCE_GENERATION, NULL), NULL); }     // Keep going until paused
-        else { KillTimer(hFrame, timerId); }                                                                // Terminate timer if paused
+        if (!session.pause) { SendMessage(hFrame, WM_COMMAND, MAKEWPARAM(WM_ADVANCE_GENERATION, NULL), NULL); }     // Keep going until paused
+        else { KillTimer(hFrame, timerId); }                                                                        // Terminate timer if paused
     }
 }
 
-void ToggleCellState(HWND hCell) {
-    if (generationIndex < history.Generation()) { return; }   // Only allow editing of latest generation
+void ToggleCellState(GAME_SESSION& session, HWND hCell) {
+    auto& history = session.history;
+    if (session.generationIndex < history.Generation()) { return; }   // Only allow editing of latest generation
     auto& frame = history.GetLatestGeneration();
     auto id = WINDOWS_TABLE::CELL_ID{ hCell };
     frame[id].TogleDeadAlive();
+    session.replayLog.RecordToggle(history.Generation(), id);
     WINDOW{ id }.Redraw();
-    for (auto& neighbor : adjacencyList[id]) {
+    for (auto& neighbor : NEIGHBOR_POSITIONS{ id, history.Size() }) {
         WINDOW{ WINDOWS_TABLE::CELL_ID{ neighbor } }.Redraw();  // Re-render neighbors 
     }
-    if (!pause) { TogglePause(); }  // Pause if not already paused
+    if (!session.pause) { TogglePause(session); }  // Pause if not already paused
     SetFocus(g_hWnd);
 }
 
-void RedrawCell(HWND hCell) {
-    const auto& frame = history[generationIndex];
+void RedrawCell(GAME_SESSION& session, HWND hCell) {
+    const auto& frame = session.history[session.generationIndex];
     auto id = WINDOWS_TABLE::CELL_ID{ hCell };
     auto state = frame.LifeState(CELL_POSITION{ id });
     auto myCell = WINDOW{ id };
     auto rekt = myCell.GetClientRect();
     auto paintToken = myCell.BeginPaint();
-    auto& brush = pause && useExtendedBrushes ? extendedBrushes[state] : simpleBrushes[state];    // Extra info on pause
+    auto& brush = session.pause && session.useExtendedBrushes ? session.extendedBrushes[state] : session.simpleBrushes[state];    // Extra info on pause
     FillRect(paintToken, &rekt, brush);
+}
+
+// Session file: a SESSION_HEADER (see SessionFile.h), then the life history snapshot
+// Write the whole session, replacing any previous session file only once the new one is complete
+void SaveSession(const GAME_SESSION& session) {
+    try {
+        WriteFileAtomically(session.sessionPath, [&session](ostream& stream) {
+            SESSION_HEADER{ session.generationIndex, session.pause, session.useExtendedBrushes }.Write(stream);
+            session.history.Save(stream, true);
+        });
+    }
+    catch (const exception& error) {
+        MessageBox(g_hWnd, StringToWstring(error.what()).c_str(), L"Unable to save session", MB_OK | MB_ICONERROR);
+    }
+}
+
+// Restore a saved session, leaving the current one untouched if the file cannot be read
+// The window shows a fixed grid of cells, so only snapshots of the same board size are accepted
+void LoadSession(GAME_SESSION& session) {
+    try {
+        auto stream = ifstream{ session.sessionPath, ios::binary };
+        auto saved = SESSION_HEADER::Read(stream);
+        auto savedHistory = LIFE_HISTORY::Load(stream);
+        if (savedHistory.Size() != session.history.Size()) { throw runtime_error{ "Saved session board size does not match." }; }
+
+        session.history = move(savedHistory);
+        session.generationIndex = clamp(saved.generationIndex, session.history.FirstGeneration(), session.history.Generation());
+        session.useExtendedBrushes = saved.useExtendedBrushes;
+        if (session.pause != saved.pause) { TogglePause(session); ResetTimer(g_hWnd); }
+        StartReplayLog(session);       // The restored generation is the new starting point
+    }
+    catch (const exception& error) {
+        MessageBox(g_hWnd, StringToWstring(error.what()).c_str(), L"Unable to load session", MB_OK | MB_ICONERROR);
+        return;
+    }
+
+    auto msg = to_wstring(session.generationIndex);
+    if (session.generationIndex < session.history.Generation()) { msg = L"**"s + msg + L"**"s; }
+    session.generationNumDisplay.Wtext(msg);
+    WINDOW{ g_hWnd }.Redraw();
+    for (auto& cell : session.cells) { cell.Redraw(); }
 }
\ No newline at end of file
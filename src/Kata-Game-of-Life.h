@@ -1,57 +1,56 @@
 #pragma once
 #include "framework.h"
 #include "Table.h"
+#include "ReplayLog.h"
+#include "SessionFile.h"
+#include "Palette.h"
 using namespace std;
 using namespace RYANS_UTILITIES;
 using namespace RYANS_UTILITIES::WINDOWS_GUI;
 
-inline auto g_table = WINDOWS_TABLE{ };
-inline auto allCells = vector<WINDOW>{ };
-inline LIFE_HISTORY history{ };
-inline auto generationIndex = size_t{ 0 };
-inline auto pause = true;
 inline constexpr auto timeIncrement = 10ull; // miliseconds
 inline constexpr auto timerId = 1000;
 inline constexpr auto WM_ADVANCE_GENERATION = 1001;
 inline constexpr auto ID_PLAY_PAUSE = 1002ul;
 inline constexpr auto ID_GENERATION_LABEL = 1003ul;
 inline constexpr auto IDC_TOGGLE_EXTENDED = 1004ul;
-inline auto playPauseDisplay = WINDOW{ }, generationNumDisplay = WINDOW{ }, buttonToggleExtendedBrushes = WINDOW{ };
+inline constexpr auto autosaveInterval = 1000ull;   // generations
+inline constexpr auto sessionFileName = L"Kata-Game-of-Life.session";
+inline constexpr auto replayFileName = L"Kata-Game-of-Life.replay";
 
-inline auto simpleBrushes = map<LIFE_STATE, HBRUSH>{
-    { LIFE_STATE::STABLE_DEAD , CreateSolidBrush(RGB(0, 0, 0))},
-    { LIFE_STATE::RECENTLY_DEAD , CreateSolidBrush(RGB(0, 0, 0))},
-    { LIFE_STATE::ALIVE , CreateSolidBrush(RGB(0, 255, 0))},
-    { LIFE_STATE::DYING , CreateSolidBrush(RGB(0, 255, 0))},
-    { LIFE_STATE::WILL_LIVE , CreateSolidBrush(RGB(0, 0, 0))},
-    { LIFE_STATE::VASCILATING , CreateSolidBrush(RGB(0, 0, 0))},
-    { LIFE_STATE::RECENTLY_GROWN , CreateSolidBrush(RGB(0, 255, 0))},
-    { LIFE_STATE::STABLE_LIVING , CreateSolidBrush(RGB(0, 255, 0))},
+// Everything one game window displays & edits
+// Created with the frame window & stored in its user data (see WndProc), so nothing is built before WinMain runs
+struct GAME_SESSION {
+    WINDOWS_TABLE table{ };
+    vector<WINDOW> cells{ };
+    LIFE_HISTORY history{ };
+    size_t generationIndex{ 0 };
+    bool pause{ true };
+    bool useExtendedBrushes{ true };
+    filesystem::path sessionPath{ sessionFileName };
+    filesystem::path replayPath{ replayFileName };
+    REPLAY_LOG replayLog{ };
+    WINDOW playPauseDisplay{ }, generationNumDisplay{ }, buttonToggleExtendedBrushes{ };
+    map<LIFE_STATE, HBRUSH> simpleBrushes{ };
+    map<LIFE_STATE, HBRUSH> extendedBrushes{ };
 };
 
-inline auto useExtendedBrushes = true;
-
-inline auto extendedBrushes = map<LIFE_STATE, HBRUSH>{
-    { LIFE_STATE::STABLE_DEAD , CreateSolidBrush(RGB(0, 0, 0))},
-    { LIFE_STATE::RECENTLY_DEAD , CreateSolidBrush(RGB(100, 0, 0))},
-    { LIFE_STATE::ALIVE , CreateSolidBrush(RGB(0, 0, 255))},
-    { LIFE_STATE::DYING , CreateSolidBrush(RGB(255, 0, 255))},
-    { LIFE_STATE::WILL_LIVE , CreateSolidBrush(RGB(0, 100, 0))},
-    { LIFE_STATE::VASCILATING , CreateSolidBrush(RGB(100, 0, 100))},
-    { LIFE_STATE::RECENTLY_GROWN , CreateSolidBrush(RGB(0, 255, 255))},
-    { LIFE_STATE::STABLE_LIVING , CreateSolidBrush(RGB(255, 255, 255))},
-};
+// Session belonging to a frame window, or null before WM_CREATE & after WM_DESTROY
+inline GAME_SESSION* GetGameSession(HWND hFrame) noexcept { return reinterpret_cast<GAME_SESSION*>(GetWindowLongPtr(hFrame, GWLP_USERDATA)); }
 
 LRESULT CALLBACK WndProc(HWND hFrame, UINT message, WPARAM wParam, LPARAM lParam);
 INT_PTR CALLBACK About(HWND hDlg, UINT message, WPARAM wParam, LPARAM lParam);
 LRESULT CALLBACK CellWindowProc(HWND hCell, UINT message, WPARAM wParam, LPARAM lParam);
 
 void InitializeGame(HWND hFrame);
-void TogglePause();
-void StepGeneration(int step);
+void TogglePause(GAME_SESSION& session);
+void StepGeneration(GAME_SESSION& session, int step);
 void ResetTimer(HWND hFrame);
-void ToggleExtendedBrushes(HWND hFrame);
+void ToggleExtendedBrushes(GAME_SESSION& session, HWND hFrame);
 void CleanupGameResources(HWND hFrame);
-void CheckTimer(HWND hFrame);
-void ToggleCellState(HWND hCell);
-void RedrawCell(HWND hCell);
+void CheckTimer(GAME_SESSION& session, HWND hFrame);
+void ToggleCellState(GAME_SESSION& session, HWND hCell);
+void RedrawCell(GAME_SESSION& session, HWND hCell);
+void SaveSession(const GAME_SESSION& session);
+void LoadSession(GAME_SESSION& session);
+void StartReplayLog(GAME_SESSION& session);
@@ -0,0 +1,44 @@
+#ifndef LIFE_PALETTE_H
+#define LIFE_PALETTE_H
+#include "framework.h"
+#include "CELL.h"
+
+struct PALETTE_COLOR {
+	std::uint8_t red{ 0 };
+	std::uint8_t green{ 0 };
+	std::uint8_t blue{ 0 };
+};
+
+// A color for every LIFE_STATE, indexed by the state's value
+// The GUI paints its cells & the exporter encodes its images from the same palettes, so both look alike
+using LIFE_PALETTE = std::array<PALETTE_COLOR, 8>;
+
+[[nodiscard]] constexpr PALETTE_COLOR PaletteColor(const LIFE_PALETTE& palette, LIFE_STATE state) noexcept {
+	return palette[static_cast<size_t>(state)];
+}
+
+// Plain alive/dead, shown while running
+inline constexpr auto simplePalette = LIFE_PALETTE{ {
+	{ 0, 0, 0 },		// STABLE_DEAD
+	{ 0, 0, 0 },		// RECENTLY_DEAD
+	{ 0, 255, 0 },		// ALIVE
+	{ 0, 255, 0 },		// DYING
+	{ 0, 0, 0 },		// WILL_LIVE
+	{ 0, 0, 0 },		// VASCILATING
+	{ 0, 255, 0 },		// RECENTLY_GROWN
+	{ 0, 255, 0 }		// STABLE_LIVING
+} };
+
+// Each state in its own color, shown while paused
+inline constexpr auto extendedPalette = LIFE_PALETTE{ {
+	{ 0, 0, 0 },		// STABLE_DEAD
+	{ 100, 0, 0 },		// RECENTLY_DEAD
+	{ 0, 0, 255 },		// ALIVE
+	{ 255, 0, 255 },	// DYING
+	{ 0, 100, 0 },		// WILL_LIVE
+	{ 100, 0, 100 },	// VASCILATING
+	{ 0, 255, 255 },	// RECENTLY_GROWN
+	{ 255, 255, 255 }	// STABLE_LIVING
+} };
+
+#endif // !LIFE_PALETTE_H
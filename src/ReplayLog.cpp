@@ -0,0 +1,83 @@
+#include "framework.h"
+#include "ReplayLog.h"
+#include "Utilities.h"
+using namespace std;
+using namespace RYANS_UTILITIES;
+
+// Log layout (native byte order)
+// Header: magic, version, then a life history snapshot of the starting generation
+// Events: type, generation #, row, column, frame hash (fixed size, zero where unused)
+constexpr auto replayMagic = std::array<char, 4>{ 'K', 'G', 'L', 'R' };
+constexpr auto replayVersion = std::uint32_t{ 1 };
+
+void REPLAY_LOG::Start(const std::filesystem::path& path, const LIFE_HISTORY& history) {
+	m_File = std::ofstream{ path, std::ios::binary | std::ios::trunc };
+	if (!m_File) { throw std::runtime_error{ "Unable to open " + path.string() + " for writing." }; }
+	m_File.write(replayMagic.data(), replayMagic.size());
+	WriteBinary(m_File, replayVersion);
+	history.Save(m_File, false);
+	m_File.flush();
+}
+
+void REPLAY_LOG::Record(const EVENT& event) noexcept {
+	if (!*this) { return; }
+	WriteBinary(m_File, event.type);
+	WriteBinary(m_File, event.generation);
+	WriteBinary(m_File, static_cast<std::uint32_t>(event.position.row));
+	WriteBinary(m_File, static_cast<std::uint32_t>(event.position.column));
+	WriteBinary(m_File, event.frameHash);
+	m_File.flush();		// Each event reaches the file even if the session ends abruptly
+}
+
+void REPLAY_LOG::RecordToggle(size_t generation, CELL_POSITION position) noexcept {
+	Record(EVENT{ EVENT_TYPE::TOGGLE, generation, position, 0 });
+}
+
+void REPLAY_LOG::RecordAdvance(const LIFE_HISTORY& history) noexcept {
+	Record(EVENT{ EVENT_TYPE::ADVANCE, history.Generation(), CELL_POSITION{ }, history[history.Generation()].Hash() });
+}
+
+[[nodiscard]] REPLAY_LOG::REPLAY_RESULT REPLAY_LOG::Replay(std::istream& stream, LIFE_HISTORY::ENGINE engine) {
+	auto magic = std::array<char, 4>{ };
+	stream.read(magic.data(), magic.size());
+	if (!stream || magic != replayMagic) { throw std::runtime_error{ "Not a replay log." }; }
+	if (ReadBinary<std::uint32_t>(stream) != replayVersion) { throw std::runtime_error{ "Unsupported replay log version." }; }
+
+	auto result = REPLAY_RESULT{ LIFE_HISTORY::Load(stream) };
+	auto& history = result.history;
+	history.Engine(engine);
+
+	// Read every event up front so that timing covers only the engine
+	auto events = std::vector<EVENT>{ };
+	while (stream.peek() != std::char_traits<char>::eof()) {
+		auto event = EVENT{ };
+		event.type = ReadBinary<EVENT_TYPE>(stream);
+		event.generation = ReadBinary<std::uint64_t>(stream);
+		event.position.row = ReadBinary<std::uint32_t>(stream);
+		event.position.column = ReadBinary<std::uint32_t>(stream);
+		event.frameHash = ReadBinary<std::uint64_t>(stream);
+		if (!stream) { break; }			// A partial trailing record means the session ended mid-write
+		events.push_back(event);
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	for (auto& event : events) {
+		switch (event.type) {
+			case EVENT_TYPE::TOGGLE: {
+				if (event.generation != history.Generation()) { throw std::runtime_error{ "Replay log edits a generation other than the latest." }; }
+				if (!history.Size().Contains(event.position)) { throw std::runtime_error{ "Replay log edits a cell outside the board." }; }
+				history.GetLatestGeneration()[event.position].TogleDeadAlive();
+				++result.toggles;
+			} break;
+			case EVENT_TYPE::ADVANCE: {
+				if (event.generation <= history.Generation()) { throw std::runtime_error{ "Replay log advances to a generation already passed." }; }
+				const auto& frame = history.Advance(static_cast<size_t>(event.generation) - history.Generation());
+				if (event.frameHash != frame.Hash() && result.mismatches++ == 0) { result.firstMismatch = history.Generation(); }
+				++result.advances;
+			} break;
+			default: { throw std::runtime_error{ "Unknown replay log event." }; }
+		}
+	}
+	result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return result;
+}
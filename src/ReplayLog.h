@@ -0,0 +1,53 @@
+#ifndef REPLAY_LOG_CLASS_H
+#define REPLAY_LOG_CLASS_H
+#include "framework.h"
+#include "CELL.h"
+
+// REPLAY_LOG records a session as an append-only stream of events
+// The log opens with a snapshot of the starting generation, then one fixed-size record per event
+// Every user edit is a TOGGLE event and every step or jump ahead is an ADVANCE event to the generation reached
+// ADVANCE events carry the hash of the generation produced, so a replay can prove it is bit-identical
+// Replaying needs no GUI, which makes a recorded session a repeatable benchmark workload
+class REPLAY_LOG {
+public:
+	enum class EVENT_TYPE : std::uint8_t {
+		TOGGLE = 1,
+		ADVANCE = 2
+	};
+
+	struct EVENT {
+		EVENT_TYPE type{ EVENT_TYPE::ADVANCE };
+		std::uint64_t generation{ 0 };		// Generation edited (TOGGLE) or produced (ADVANCE)
+		CELL_POSITION position{ };			// TOGGLE only
+		std::uint64_t frameHash{ 0 };		// ADVANCE only
+	};
+
+	struct REPLAY_RESULT {
+		LIFE_HISTORY history{ };
+		size_t toggles{ 0 };
+		size_t advances{ 0 };
+		size_t mismatches{ 0 };				// ADVANCE events whose recorded hash differs from the replayed generation
+		size_t firstMismatch{ 0 };			// Generation # of the first mismatch, if any
+		double seconds{ 0.0 };				// Time spent applying events
+	};
+
+private:
+	std::ofstream m_File{ };
+	void Record(const EVENT& event) noexcept;
+
+public:
+	// Begin a new log, replacing any existing file, starting from the latest generation of the history
+	void Start(const std::filesystem::path& path, const LIFE_HISTORY& history);
+	void Stop() noexcept { m_File.close(); }
+	explicit operator bool() const noexcept { return m_File.is_open() && m_File.good(); }
+
+	void RecordToggle(size_t generation, CELL_POSITION position) noexcept;
+	// Call after every step or jump, once the history has reached the new generation
+	void RecordAdvance(const LIFE_HISTORY& history) noexcept;
+
+	// Rebuild a session from its log as fast as the engine allows
+	// Throws std::runtime_error if the log is malformed or an event cannot apply
+	[[nodiscard]] static REPLAY_RESULT Replay(std::istream& stream, LIFE_HISTORY::ENGINE engine);
+};
+
+#endif // !REPLAY_LOG_CLASS_H
@@ -0,0 +1,29 @@
+#include "framework.h"
+#include "SessionFile.h"
+#include "Utilities.h"
+using namespace std;
+using namespace RYANS_UTILITIES;
+
+constexpr auto sessionMagic = array<char, 4>{ 'K', 'G', 'L', 'S' };
+constexpr auto sessionVersion = uint32_t{ 1 };
+
+void SESSION_HEADER::Write(ostream& stream) const {
+	stream.write(sessionMagic.data(), sessionMagic.size());
+	WriteBinary(stream, sessionVersion);
+	WriteBinary(stream, static_cast<uint64_t>(generationIndex));
+	WriteBinary(stream, static_cast<uint8_t>(pause));
+	WriteBinary(stream, static_cast<uint8_t>(useExtendedBrushes));
+}
+
+[[nodiscard]] SESSION_HEADER SESSION_HEADER::Read(istream& stream) {
+	auto magic = array<char, 4>{ };
+	stream.read(magic.data(), magic.size());
+	if (!stream || magic != sessionMagic) { throw runtime_error{ "No saved session found." }; }
+	if (ReadBinary<uint32_t>(stream) != sessionVersion) { throw runtime_error{ "Unsupported session version." }; }
+	auto header = SESSION_HEADER{ };
+	header.generationIndex = static_cast<size_t>(ReadBinary<uint64_t>(stream));
+	header.pause = ReadBinary<uint8_t>(stream) != 0;
+	header.useExtendedBrushes = ReadBinary<uint8_t>(stream) != 0;
+	if (!stream) { throw runtime_error{ "Session file ends early." }; }
+	return header;
+}
@@ -0,0 +1,20 @@
+#ifndef SESSION_FILE_CLASS_H
+#define SESSION_FILE_CLASS_H
+#include "framework.h"
+
+// SESSION_HEADER is the display state the GUI saves ahead of the life history in a session file
+// Layout (native byte order): magic, version, displayed generation #, pause flag, brush mode, then a LIFE_HISTORY snapshot
+// It lives with the engine so headless tools can read the sessions the GUI saves
+struct SESSION_HEADER {
+	size_t generationIndex{ 0 };
+	bool pause{ true };
+	bool useExtendedBrushes{ true };
+
+	void Write(std::ostream& stream) const;
+
+	// Leaves the stream at the life history snapshot
+	// Throws std::runtime_error if the stream does not start with a session of this version
+	[[nodiscard]] static SESSION_HEADER Read(std::istream& stream);
+};
+
+#endif // !SESSION_FILE_CLASS_H
@@ -0,0 +1,471 @@
+#include "framework.h"
+#include "Stream.h"
+#ifndef _WIN32
+#include <cerrno>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+using namespace std;
+
+constexpr auto messageHeaderSize = size_t{ 5 };
+constexpr auto subscribeSize = size_t{ 20 };
+constexpr auto largestRequest = size_t{ 256 };		// Payload bytes, far beyond any request a client sends
+
+static runtime_error SocketError(const string& what) {
+	return runtime_error{ what + ": " + strerror(errno) };
+}
+
+static void AppendLittleEndian(vector<uint8_t>& bytes, uint64_t value, size_t size) {
+	for (auto i = size_t{ 0 }; i < size; ++i) { bytes.push_back(static_cast<uint8_t>(value >> (8 * i))); }
+}
+
+static void AppendVarint(vector<uint8_t>& bytes, uint64_t value) {
+	for (; value >= 0x80; value >>= 7) { bytes.push_back(static_cast<uint8_t>(value | 0x80)); }
+	bytes.push_back(static_cast<uint8_t>(value));
+}
+
+// Message type & a length to be filled in by EndMessage, returning where the payload starts
+static size_t BeginMessage(vector<uint8_t>& bytes, STREAM_MESSAGE type) {
+	bytes.push_back(static_cast<uint8_t>(type));
+	AppendLittleEndian(bytes, 0, 4);
+	return bytes.size();
+}
+
+static void EndMessage(vector<uint8_t>& bytes, size_t payloadStart) {
+	auto length = bytes.size() - payloadStart;
+	for (auto i = size_t{ 0 }; i < 4; ++i) { bytes[payloadStart - 4 + i] = static_cast<uint8_t>(length >> (8 * i)); }
+}
+
+// Reads a payload front to back, throwing on anything cut short
+class PAYLOAD_READER {
+	const uint8_t* m_Next{ nullptr };
+	const uint8_t* m_End{ nullptr };
+public:
+	PAYLOAD_READER(const uint8_t* bytes, size_t size) noexcept : m_Next{ bytes }, m_End{ bytes + size } { }
+
+	uint64_t LittleEndian(size_t size) {
+		if (static_cast<size_t>(m_End - m_Next) < size) { throw runtime_error{ "Stream message cut short." }; }
+		auto value = uint64_t{ 0 };
+		for (auto i = size_t{ 0 }; i < size; ++i) { value |= uint64_t{ *m_Next++ } << (8 * i); }
+		return value;
+	}
+
+	uint64_t Varint() {
+		auto value = uint64_t{ 0 };
+		for (auto shift = 0u; shift < 64; shift += 7) {
+			auto byte = LittleEndian(1);
+			value |= (byte & 0x7f) << shift;
+			if ((byte & 0x80) == 0) { return value; }
+		}
+		throw runtime_error{ "Stream message holds an oversized number." };
+	}
+};
+
+static CELL_REGION ClipViewport(BOARD_SIZE size, uint64_t row, uint64_t column, uint64_t height, uint64_t width) noexcept {
+	auto first = CELL_POSITION{ static_cast<unsigned int>(min<uint64_t>(row, size.height)), static_cast<unsigned int>(min<uint64_t>(column, size.width)) };
+	return CELL_REGION{ first, CELL_POSITION{
+		first.row + static_cast<unsigned int>(min<uint64_t>(height, size.height - first.row)),
+		first.column + static_cast<unsigned int>(min<uint64_t>(width, size.width - first.column)) } };
+}
+
+static void MakeNonBlocking(int socket) {
+	auto flags = ::fcntl(socket, F_GETFL, 0);
+	if (flags < 0 || ::fcntl(socket, F_SETFL, flags | O_NONBLOCK) < 0) { throw SocketError("Unable to make socket non-blocking"); }
+}
+
+// Frames are small & latency matters more than packet count
+static void DisableNagle(int socket) noexcept {
+	auto enable = 1;
+	::setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+}
+
+FRAME_STREAM_SERVER::FRAME_STREAM_SERVER(BOARD_SIZE size, uint16_t port) : m_Size{ size } {
+	auto fail = [this](const string& what) {
+		auto error = SocketError(what);
+		for (auto descriptor : { m_Listener, m_Wake[0], m_Wake[1] }) {
+			if (descriptor >= 0) { ::close(descriptor); }
+		}
+		return error;
+	};
+
+	m_Listener = ::socket(AF_INET, SOCK_STREAM, 0);
+	if (m_Listener < 0) { throw fail("Unable to create stream socket"); }
+	auto reuse = 1;
+	::setsockopt(m_Listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+	auto address = sockaddr_in{ };
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	address.sin_port = htons(port);
+	if (::bind(m_Listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) { throw fail("Unable to bind stream port " + to_string(port)); }
+	if (::listen(m_Listener, SOMAXCONN) != 0) { throw fail("Unable to listen on stream port"); }
+	auto length = socklen_t{ sizeof(address) };
+	if (::getsockname(m_Listener, reinterpret_cast<sockaddr*>(&address), &length) != 0) { throw fail("Unable to find stream port"); }
+	m_Port = ntohs(address.sin_port);
+	if (::pipe(m_Wake.data()) != 0) { throw fail("Unable to create wake pipe"); }
+	try {
+		MakeNonBlocking(m_Listener);
+		MakeNonBlocking(m_Wake[0]);
+		MakeNonBlocking(m_Wake[1]);
+	}
+	catch (const runtime_error&) { throw fail("Unable to make socket non-blocking"); }
+
+	m_Thread = thread{ [this] { Serve(); } };
+}
+
+FRAME_STREAM_SERVER::~FRAME_STREAM_SERVER() {
+	{
+		auto lock = lock_guard{ m_Mutex };
+		m_Stopping = true;
+	}
+	Wake();
+	m_Thread.join();
+	for (auto& client : m_Clients) { ::close(client.socket); }
+	for (auto descriptor : { m_Listener, m_Wake[0], m_Wake[1] }) { ::close(descriptor); }
+}
+
+void FRAME_STREAM_SERVER::Publish(size_t generationNumber, LIFE_HISTORY::FRAME_HANDLE frame) {
+	{
+		auto lock = lock_guard{ m_Mutex };
+		m_LatestGeneration = generationNumber;
+		m_Latest = move(frame);
+	}
+	Wake();
+}
+
+STREAM_SERVER_STATS FRAME_STREAM_SERVER::Stats() const {
+	auto lock = lock_guard{ m_Mutex };
+	return m_Stats;
+}
+
+// A full pipe already holds a wake-up, so a failed write loses nothing
+void FRAME_STREAM_SERVER::Wake() noexcept {
+	auto signal = uint8_t{ 0 };
+	[[maybe_unused]] auto written = ::write(m_Wake[1], &signal, 1);
+}
+
+void FRAME_STREAM_SERVER::Serve() noexcept {
+	auto descriptors = vector<pollfd>{ };
+	while (true) {
+		auto generation = size_t{ 0 };
+		auto latest = LIFE_HISTORY::FRAME_HANDLE{ };
+		{
+			auto lock = lock_guard{ m_Mutex };
+			if (m_Stopping) { return; }
+			generation = m_LatestGeneration;
+			latest = m_Latest;
+		}
+
+		// Send to every client that has caught up, then wait no longer than the next rate-limited one needs
+		auto now = chrono::steady_clock::now();
+		auto timeout = -1;
+		for (auto client = m_Clients.begin(); client != m_Clients.end(); ) {
+			auto ready = latest && client->subscribed && client->outbox.empty() && (client->needsKeyframe || client->generation != generation);
+			if (ready && now < client->nextDue) {
+				auto wait = chrono::duration_cast<chrono::milliseconds>(client->nextDue - now).count() + 1;
+				timeout = timeout < 0 ? static_cast<int>(wait) : min(timeout, static_cast<int>(wait));
+			}
+			else if (ready) { SendFrame(*client, generation, *latest, now); }
+
+			if (Flush(*client)) { ++client; }
+			else {
+				::close(client->socket);
+				client = m_Clients.erase(client);
+				auto lock = lock_guard{ m_Mutex };
+				m_Stats.clients = m_Clients.size();
+			}
+		}
+
+		descriptors.clear();
+		descriptors.push_back(pollfd{ m_Wake[0], POLLIN, 0 });
+		descriptors.push_back(pollfd{ m_Listener, POLLIN, 0 });
+		for (const auto& client : m_Clients) { descriptors.push_back(pollfd{ client.socket, static_cast<short>(POLLIN | (client.outbox.empty() ? 0 : POLLOUT)), 0 }); }
+		if (::poll(descriptors.data(), descriptors.size(), timeout) < 0) { continue; }
+
+		if (descriptors[0].revents & POLLIN) {
+			auto drained = array<uint8_t, 64>{ };
+			while (::read(m_Wake[0], drained.data(), drained.size()) > 0) { }
+		}
+		auto polled = descriptors.begin() + 2;
+		for (auto client = m_Clients.begin(); client != m_Clients.end(); ++polled) {
+			auto open = true;
+			if (polled->revents & (POLLIN | POLLHUP | POLLERR)) { open = ReadRequests(*client); }
+			if (open && (polled->revents & POLLOUT)) { open = Flush(*client); }
+			if (open) { ++client; }
+			else {
+				::close(client->socket);
+				client = m_Clients.erase(client);
+				auto lock = lock_guard{ m_Mutex };
+				m_Stats.clients = m_Clients.size();
+			}
+		}
+		if (descriptors[1].revents & POLLIN) {
+			try { Accept(); }
+			catch (const runtime_error&) { }		// The client gave up before it was accepted
+		}
+	}
+}
+
+void FRAME_STREAM_SERVER::Accept() {
+	while (true) {
+		auto socket = ::accept(m_Listener, nullptr, nullptr);
+		if (socket < 0) { return; }
+		auto& client = m_Clients.emplace_back();
+		client.socket = socket;
+		MakeNonBlocking(socket);
+		DisableNagle(socket);
+		auto start = BeginMessage(client.outbox, STREAM_MESSAGE::BOARD);
+		AppendLittleEndian(client.outbox, m_Size.width, 4);
+		AppendLittleEndian(client.outbox, m_Size.height, 4);
+		EndMessage(client.outbox, start);
+		auto lock = lock_guard{ m_Mutex };
+		m_Stats.clients = m_Clients.size();
+	}
+}
+
+// False once the client has gone or sent something outside the protocol
+bool FRAME_STREAM_SERVER::ReadRequests(CLIENT& client) {
+	auto buffer = array<uint8_t, 4096>{ };
+	while (true) {
+		auto received = ::recv(client.socket, buffer.data(), buffer.size(), 0);
+		if (received == 0) { return false; }
+		if (received < 0) {
+			if (errno == EINTR) { continue; }
+			if (errno == EAGAIN || errno == EWOULDBLOCK) { break; }
+			return false;
+		}
+		client.inbox.insert(client.inbox.end(), buffer.data(), buffer.data() + received);
+	}
+
+	auto consumed = size_t{ 0 };
+	while (client.inbox.size() - consumed >= messageHeaderSize) {
+		auto header = PAYLOAD_READER{ client.inbox.data() + consumed, messageHeaderSize };
+		auto type = static_cast<STREAM_MESSAGE>(header.LittleEndian(1));
+		auto length = static_cast<size_t>(header.LittleEndian(4));
+		if (type != STREAM_MESSAGE::SUBSCRIBE || length != subscribeSize || length > largestRequest) { return false; }
+		if (client.inbox.size() - consumed < messageHeaderSize + length) { break; }
+
+		auto request = PAYLOAD_READER{ client.inbox.data() + consumed + messageHeaderSize, length };
+		auto row = request.LittleEndian(4);
+		auto column = request.LittleEndian(4);
+		auto height = request.LittleEndian(4);
+		auto width = request.LittleEndian(4);
+		auto framesPerSecond = request.LittleEndian(4);
+		client.viewport = ClipViewport(m_Size, row, column, height, width);
+		client.interval = framesPerSecond > 0 ? chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>{ 1.0 / static_cast<double>(framesPerSecond) }) : chrono::steady_clock::duration{ };
+		client.nextDue = chrono::steady_clock::now();
+		client.subscribed = true;
+		client.needsKeyframe = true;
+		consumed += messageHeaderSize + length;
+	}
+	client.inbox.erase(client.inbox.begin(), client.inbox.begin() + consumed);
+	return true;
+}
+
+// Write as much of the outbox as the socket takes without blocking
+// False once the client has gone
+bool FRAME_STREAM_SERVER::Flush(CLIENT& client) {
+	auto written = size_t{ 0 };
+	while (client.sent < client.outbox.size()) {
+		auto sent = ::send(client.socket, client.outbox.data() + client.sent, client.outbox.size() - client.sent, MSG_NOSIGNAL);
+		if (sent < 0 && errno == EINTR) { continue; }
+		if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) { break; }
+		if (sent <= 0) { return false; }
+		client.sent += static_cast<size_t>(sent);
+		written += static_cast<size_t>(sent);
+	}
+	if (client.sent == client.outbox.size()) {
+		client.outbox.clear();
+		client.sent = 0;
+	}
+	if (written > 0) {
+		auto lock = lock_guard{ m_Mutex };
+		m_Stats.bytes += written;
+	}
+	return true;
+}
+
+void FRAME_STREAM_SERVER::SendFrame(CLIENT& client, size_t generation, const TIME_SLICE& frame, chrono::steady_clock::time_point now) {
+	const auto viewport = client.viewport;
+	auto& bytes = client.outbox;
+	auto keyframe = client.needsKeyframe;
+	auto coalesced = keyframe || generation <= client.generation ? size_t{ 0 } : generation - client.generation - 1;
+
+	auto start = BeginMessage(bytes, keyframe ? STREAM_MESSAGE::KEYFRAME : STREAM_MESSAGE::DELTA);
+	AppendLittleEndian(bytes, generation, 8);
+	if (keyframe) {
+		AppendLittleEndian(bytes, viewport.first.row, 4);
+		AppendLittleEndian(bytes, viewport.first.column, 4);
+		AppendLittleEndian(bytes, viewport.Height(), 4);
+		AppendLittleEndian(bytes, viewport.Width(), 4);
+		client.states.resize(static_cast<size_t>(viewport.Height()) * viewport.Width());
+		auto run = uint64_t{ 0 };
+		auto state = uint8_t{ 0 };
+		auto index = size_t{ 0 };
+		for (auto row = viewport.first.row; row < viewport.end.row; ++row) {
+			for (auto column = viewport.first.column; column < viewport.end.column; ++column, ++index) {
+				auto next = static_cast<uint8_t>(frame.LifeState(CELL_POSITION{ row, column }));
+				client.states[index] = next;
+				if (run > 0 && next != state) {
+					AppendVarint(bytes, run);
+					bytes.push_back(state);
+					run = 0;
+				}
+				state = next;
+				++run;
+			}
+		}
+		if (run > 0) {
+			AppendVarint(bytes, run);
+			bytes.push_back(state);
+		}
+	}
+	else {
+		auto countAt = bytes.size();
+		AppendLittleEndian(bytes, 0, 4);
+		auto changes = uint32_t{ 0 };
+		auto index = size_t{ 0 };
+		auto lastChange = size_t{ 0 };
+		for (auto row = viewport.first.row; row < viewport.end.row; ++row) {
+			for (auto column = viewport.first.column; column < viewport.end.column; ++column, ++index) {
+				auto next = static_cast<uint8_t>(frame.LifeState(CELL_POSITION{ row, column }));
+				if (next == client.states[index]) { continue; }
+				client.states[index] = next;
+				AppendVarint(bytes, index - lastChange);
+				bytes.push_back(next);
+				lastChange = index + 1;
+				++changes;
+			}
+		}
+		for (auto i = size_t{ 0 }; i < 4; ++i) { bytes[countAt + i] = static_cast<uint8_t>(changes >> (8 * i)); }
+	}
+	EndMessage(bytes, start);
+
+	client.generation = generation;
+	client.needsKeyframe = false;
+	client.nextDue = now + client.interval;
+	auto lock = lock_guard{ m_Mutex };
+	++(keyframe ? m_Stats.keyframes : m_Stats.deltas);
+	m_Stats.generationsCoalesced += coalesced;
+}
+
+FRAME_STREAM_CLIENT::FRAME_STREAM_CLIENT(uint16_t port) {
+	m_Socket = ::socket(AF_INET, SOCK_STREAM, 0);
+	if (m_Socket < 0) { throw SocketError("Unable to create stream socket"); }
+	auto address = sockaddr_in{ };
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	address.sin_port = htons(port);
+	if (::connect(m_Socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+		auto error = SocketError("Unable to connect to stream port " + to_string(port));
+		::close(m_Socket);
+		throw error;
+	}
+	DisableNagle(m_Socket);
+	try {
+		if (!Receive() || m_Size.CellCount() == 0) { throw runtime_error{ "Stream server closed before describing its board." }; }
+	}
+	catch (...) {
+		::close(m_Socket);
+		throw;
+	}
+}
+
+FRAME_STREAM_CLIENT::~FRAME_STREAM_CLIENT() {
+	::close(m_Socket);
+}
+
+void FRAME_STREAM_CLIENT::ReceiveBytes(void* data, size_t size) {
+	auto* bytes = static_cast<char*>(data);
+	while (size > 0) {
+		auto received = ::recv(m_Socket, bytes, size, 0);
+		if (received < 0 && errno == EINTR) { continue; }
+		if (received == 0) { throw runtime_error{ "Stream closed in the middle of a message." }; }
+		if (received < 0) { throw SocketError("Stream receive failed"); }
+		bytes += received;
+		size -= static_cast<size_t>(received);
+	}
+}
+
+void FRAME_STREAM_CLIENT::Subscribe(CELL_REGION viewport, unsigned int framesPerSecond) {
+	auto bytes = vector<uint8_t>{ };
+	auto start = BeginMessage(bytes, STREAM_MESSAGE::SUBSCRIBE);
+	AppendLittleEndian(bytes, viewport.first.row, 4);
+	AppendLittleEndian(bytes, viewport.first.column, 4);
+	AppendLittleEndian(bytes, viewport.Height(), 4);
+	AppendLittleEndian(bytes, viewport.Width(), 4);
+	AppendLittleEndian(bytes, framesPerSecond, 4);
+	EndMessage(bytes, start);
+	for (auto sent = size_t{ 0 }; sent < bytes.size(); ) {
+		auto count = ::send(m_Socket, bytes.data() + sent, bytes.size() - sent, MSG_NOSIGNAL);
+		if (count < 0 && errno == EINTR) { continue; }
+		if (count <= 0) { throw SocketError("Stream send failed"); }
+		sent += static_cast<size_t>(count);
+	}
+}
+
+bool FRAME_STREAM_CLIENT::Receive() {
+	auto header = array<uint8_t, messageHeaderSize>{ };
+	auto received = ::recv(m_Socket, header.data(), header.size(), 0);
+	while (received < 0 && errno == EINTR) { received = ::recv(m_Socket, header.data(), header.size(), 0); }
+	if (received == 0) { return false; }
+	if (received < 0) { throw SocketError("Stream receive failed"); }
+	ReceiveBytes(header.data() + received, header.size() - static_cast<size_t>(received));
+
+	auto headerReader = PAYLOAD_READER{ header.data(), header.size() };
+	auto type = static_cast<STREAM_MESSAGE>(headerReader.LittleEndian(1));
+	m_Payload.resize(static_cast<size_t>(headerReader.LittleEndian(4)));
+	ReceiveBytes(m_Payload.data(), m_Payload.size());
+	m_Stats.bytes += header.size() + m_Payload.size();
+
+	auto payload = PAYLOAD_READER{ m_Payload.data(), m_Payload.size() };
+	switch (type) {
+	case STREAM_MESSAGE::BOARD:
+		m_Size.width = static_cast<unsigned int>(payload.LittleEndian(4));
+		m_Size.height = static_cast<unsigned int>(payload.LittleEndian(4));
+		return true;
+	case STREAM_MESSAGE::KEYFRAME: {
+		m_Generation = static_cast<size_t>(payload.LittleEndian(8));
+		auto row = payload.LittleEndian(4);
+		auto column = payload.LittleEndian(4);
+		auto height = payload.LittleEndian(4);
+		auto width = payload.LittleEndian(4);
+		m_Viewport = ClipViewport(m_Size, row, column, height, width);
+		if (m_Viewport.Height() != height || m_Viewport.Width() != width) { throw runtime_error{ "Stream keyframe lies outside the board." }; }
+		m_States.assign(static_cast<size_t>(height) * width, 0);
+		for (auto filled = size_t{ 0 }; filled < m_States.size(); ) {
+			auto run = payload.Varint();
+			auto state = static_cast<uint8_t>(payload.LittleEndian(1));
+			if (run == 0 || run > m_States.size() - filled) { throw runtime_error{ "Stream keyframe runs past its viewport." }; }
+			fill_n(m_States.begin() + static_cast<ptrdiff_t>(filled), run, state);
+			filled += static_cast<size_t>(run);
+		}
+		++m_Stats.keyframes;
+		return true;
+	}
+	case STREAM_MESSAGE::DELTA: {
+		m_Generation = static_cast<size_t>(payload.LittleEndian(8));
+		auto changes = payload.LittleEndian(4);
+		auto index = size_t{ 0 };
+		for (auto change = uint64_t{ 0 }; change < changes; ++change) {
+			auto skip = payload.Varint();
+			if (skip >= m_States.size() - index) { throw runtime_error{ "Stream delta runs past its viewport." }; }
+			index += static_cast<size_t>(skip);
+			m_States[index++] = static_cast<uint8_t>(payload.LittleEndian(1));
+		}
+		++m_Stats.deltas;
+		m_Stats.changes += static_cast<size_t>(changes);
+		return true;
+	}
+	default:
+		throw runtime_error{ "Unknown stream message." };
+	}
+}
+
+LIFE_STATE FRAME_STREAM_CLIENT::LifeState(CELL_POSITION position) const noexcept {
+	return static_cast<LIFE_STATE>(m_States[static_cast<size_t>(position.row - m_Viewport.first.row) * m_Viewport.Width() + position.column - m_Viewport.first.column]);
+}
+#endif // !_WIN32
@@ -0,0 +1,136 @@
+#ifndef FRAME_STREAM_CLASS_H
+#define FRAME_STREAM_CLASS_H
+#include "framework.h"
+#include "CELL.h"
+
+// Frame streaming sends generations to viewers in other processes over a local TCP connection
+//
+// Every message is a 1-byte type & a 4-byte payload length, then the payload
+// Integers are little-endian; "varint" is 7 bits per byte, least significant first, high bit set on all but the last byte
+//   BOARD		server -> client on connect: width & height (4 bytes each)
+//   SUBSCRIBE	client -> server: viewport first row, first column, height, width (4 bytes each), then frames per second (4 bytes, 0 = every generation)
+//   KEYFRAME	server -> client: generation (8 bytes), viewport as in SUBSCRIBE clipped to the board,
+//				then the viewport's LIFE_STATEs row by row as runs: varint run length, state byte
+//   DELTA		server -> client: generation (8 bytes), number of changes (4 bytes), then per change:
+//				varint count of unchanged cells skipped since the previous change, new state byte
+// A delta holds every cell of the viewport whose state differs from the last frame sent to that client
+// The states carry a generation either side, so settled cells never change & a settled board streams almost nothing
+enum class STREAM_MESSAGE : std::uint8_t {
+	BOARD = 1,
+	KEYFRAME = 2,
+	DELTA = 3,
+	SUBSCRIBE = 16
+};
+
+struct STREAM_SERVER_STATS {
+	size_t clients{ 0 };				// Connected now
+	size_t keyframes{ 0 };
+	size_t deltas{ 0 };
+	size_t bytes{ 0 };					// Sent to all clients
+	size_t generationsCoalesced{ 0 };	// Skipped for clients that were slow or rate limited
+};
+
+struct STREAM_CLIENT_STATS {
+	size_t keyframes{ 0 };
+	size_t deltas{ 0 };
+	size_t changes{ 0 };				// Cells updated by deltas
+	size_t bytes{ 0 };					// Received, including message headers
+};
+
+#ifndef _WIN32
+// FRAME_STREAM_SERVER serves the latest published generation to any number of local clients
+// Publish only swaps in a frame handle, so the simulation never waits on a client
+// One background thread multiplexes every connection without blocking
+// A client is sent its next frame only once its last message is fully handed to the network & its rate allows,
+// so a slow client skips straight to the latest generation instead of queueing the ones in between
+class FRAME_STREAM_SERVER {
+	// A subscriber, with the states last sent to it as the base of its next delta
+	struct CLIENT {
+		int socket{ -1 };
+		std::vector<std::uint8_t> inbox{ };
+		std::vector<std::uint8_t> outbox{ };
+		size_t sent{ 0 };						// Bytes of the outbox already written
+		bool subscribed{ false };
+		bool needsKeyframe{ false };
+		CELL_REGION viewport{ };
+		std::chrono::steady_clock::duration interval{ };
+		std::chrono::steady_clock::time_point nextDue{ };
+		size_t generation{ 0 };					// Of the last frame sent
+		std::vector<std::uint8_t> states{ };	// Viewport states of the last frame sent
+	};
+
+	BOARD_SIZE m_Size{ };
+	int m_Listener{ -1 };
+	std::array<int, 2> m_Wake{ -1, -1 };		// Pipe that interrupts the server thread's wait
+	std::uint16_t m_Port{ 0 };
+	std::list<CLIENT> m_Clients{ };				// Server thread only
+	mutable std::mutex m_Mutex{ };
+	size_t m_LatestGeneration{ 0 };
+	LIFE_HISTORY::FRAME_HANDLE m_Latest{ };
+	bool m_Stopping{ false };
+	STREAM_SERVER_STATS m_Stats{ };
+	std::thread m_Thread{ };
+
+	void Serve() noexcept;
+	void Wake() noexcept;
+	void Accept();
+	[[nodiscard]] bool ReadRequests(CLIENT& client);
+	[[nodiscard]] bool Flush(CLIENT& client);
+	void SendFrame(CLIENT& client, size_t generation, const TIME_SLICE& frame, std::chrono::steady_clock::time_point now);
+
+public:
+	// Listen on the loopback interface; port 0 picks any free port (see Port)
+	// Throws std::runtime_error if the socket cannot be set up
+	explicit FRAME_STREAM_SERVER(BOARD_SIZE size, std::uint16_t port = 0);
+	FRAME_STREAM_SERVER(const FRAME_STREAM_SERVER&) = delete;
+	FRAME_STREAM_SERVER& operator=(const FRAME_STREAM_SERVER&) = delete;
+	~FRAME_STREAM_SERVER();
+
+	[[nodiscard]] std::uint16_t Port() const noexcept { return m_Port; }
+
+	// Make a generation the one sent to clients as they become ready for it
+	// The frame must be of the server's board size
+	void Publish(size_t generationNumber, LIFE_HISTORY::FRAME_HANDLE frame);
+
+	[[nodiscard]] STREAM_SERVER_STATS Stats() const;
+};
+
+// Minimal viewer side of the protocol, holding the states of its viewport
+class FRAME_STREAM_CLIENT {
+	int m_Socket{ -1 };
+	BOARD_SIZE m_Size{ 0, 0 };
+	CELL_REGION m_Viewport{ };
+	size_t m_Generation{ 0 };
+	std::vector<std::uint8_t> m_States{ };
+	std::vector<std::uint8_t> m_Payload{ };
+	STREAM_CLIENT_STATS m_Stats{ };
+
+	void ReceiveBytes(void* data, size_t size);
+
+public:
+	// Connect to a server on this machine & wait for its board size
+	// Throws std::runtime_error if the connection fails
+	explicit FRAME_STREAM_CLIENT(std::uint16_t port);
+	FRAME_STREAM_CLIENT(const FRAME_STREAM_CLIENT&) = delete;
+	FRAME_STREAM_CLIENT& operator=(const FRAME_STREAM_CLIENT&) = delete;
+	~FRAME_STREAM_CLIENT();
+
+	// Ask for a keyframe of the viewport & deltas after it, at most framesPerSecond a second (0 for every generation)
+	// Frames already on their way still arrive for the previous viewport
+	void Subscribe(CELL_REGION viewport, unsigned int framesPerSecond = 0);
+
+	// Wait for the next keyframe or delta & apply it
+	// Returns false once the server closes the connection; throws std::runtime_error on a malformed message
+	bool Receive();
+
+	[[nodiscard]] BOARD_SIZE Size() const noexcept { return m_Size; }
+	[[nodiscard]] CELL_REGION Viewport() const noexcept { return m_Viewport; }
+	[[nodiscard]] size_t Generation() const noexcept { return m_Generation; }
+	[[nodiscard]] STREAM_CLIENT_STATS Stats() const noexcept { return m_Stats; }
+
+	// State of a cell within the viewport of the last frame received
+	[[nodiscard]] LIFE_STATE LifeState(CELL_POSITION position) const noexcept;
+};
+#endif // !_WIN32
+
+#endif // !FRAME_STREAM_CLASS_H
@@ -8,9 +8,9 @@ using namespace RYANS_UTILITIES::WINDOWS_GUI;
 
 
 // Initial window setup
-void WINDOWS_TABLE::InitializeTable() noexcept {
-	for (auto i = 0; i < layoutWidth; ++i) { AddColumn(); }
-	for (auto i = 0; i < layoutHeight; ++i) { AddRow(); }
+void WINDOWS_TABLE::InitializeTable(BOARD_SIZE size) noexcept {
+	for (auto i = 0u; i < size.width; ++i) { AddColumn(); }
+	for (auto i = 0u; i < size.height; ++i) { AddRow(); }
 	Redraw();
 }
 
@@ -21,7 +21,7 @@ public:
 	void AddColumn() noexcept;
 	void RemoveRow() noexcept;
 	void RemoveColumn() noexcept;
-	void InitializeTable() noexcept;
+	void InitializeTable(BOARD_SIZE size) noexcept;
 	void Resize() noexcept;
 	void Redraw() const noexcept;
 };
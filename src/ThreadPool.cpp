@@ -0,0 +1,219 @@
+#include "framework.h"
+#include "ThreadPool.h"
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif // __linux__
+using namespace std;
+
+// NUMA node of every CPU, by CPU number
+struct NUMA_TOPOLOGY {
+	vector<size_t> cpuNodes{ };
+	size_t nodeCount{ 1 };
+};
+
+// Parse a sysfs CPU list such as "0-3,8-11"
+static vector<size_t> ParseCpuList(const string& text) {
+	auto cpus = vector<size_t>{ };
+	auto stream = istringstream{ text };
+	auto range = string{ };
+	while (getline(stream, range, ',')) {
+		auto dash = range.find('-');
+		try {
+			auto first = stoul(range.substr(0, dash));
+			auto last = dash == string::npos ? first : stoul(range.substr(dash + 1));
+			for (auto cpu = first; cpu <= last; ++cpu) { cpus.push_back(cpu); }
+		}
+		catch (const logic_error&) {}
+	}
+	return cpus;
+}
+
+static const NUMA_TOPOLOGY& Topology() noexcept {
+	static const auto topology = [] {
+		auto result = NUMA_TOPOLOGY{ };
+#ifdef __linux__
+		auto error = error_code{ };
+		for (auto entry = filesystem::directory_iterator{ "/sys/devices/system/node", error }; !error && entry != filesystem::directory_iterator{ }; entry.increment(error)) {
+			auto name = entry->path().filename().string();
+			if (name.size() <= 4 || name.compare(0, 4, "node") != 0 || !all_of(name.begin() + 4, name.end(), [](char c) { return c >= '0' && c <= '9'; })) { continue; }
+
+			auto node = size_t{ stoul(name.substr(4)) };
+			auto file = ifstream{ entry->path() / "cpulist" };
+			auto list = string{ };
+			getline(file, list);
+			for (auto cpu : ParseCpuList(list)) {
+				if (cpu >= result.cpuNodes.size()) { result.cpuNodes.resize(cpu + 1, 0); }
+				result.cpuNodes[cpu] = node;
+			}
+			result.nodeCount = max(result.nodeCount, node + 1);
+		}
+#endif // __linux__
+		return result;
+	}();
+	return topology;
+}
+
+// Cores this process may run on, those of node 0 first, then node 1 & so on
+static vector<size_t> PinningOrder() noexcept {
+	auto cores = vector<size_t>{ };
+#ifdef __linux__
+	auto allowed = cpu_set_t{ };
+	if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) { return cores; }
+	for (auto cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+		if (CPU_ISSET(cpu, &allowed)) { cores.push_back(static_cast<size_t>(cpu)); }
+	}
+
+	const auto& nodes = Topology().cpuNodes;
+	auto nodeOf = [&nodes](size_t cpu) { return cpu < nodes.size() ? nodes[cpu] : 0; };
+	stable_sort(cores.begin(), cores.end(), [&nodeOf](size_t a, size_t b) { return nodeOf(a) < nodeOf(b); });
+#endif // __linux__
+	return cores;
+}
+
+static void PinCurrentThread([[maybe_unused]] optional<size_t> core) noexcept {
+#ifdef __linux__
+	if (!core || *core >= CPU_SETSIZE) { return; }
+	auto set = cpu_set_t{ };
+	CPU_ZERO(&set);
+	CPU_SET(*core, &set);
+	pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif // __linux__
+}
+
+THREAD_POOL::THREAD_POOL(size_t threadCount, bool pinned) : m_Pinned{ pinned } {
+	if (!pinned) {
+		for (auto slot = size_t{ 1 }; slot < threadCount; ++slot) { m_Workers.emplace_back([this, slot] { WorkerLoop(slot); }); }
+		return;
+	}
+
+	auto cores = PinningOrder();
+	for (auto slot = size_t{ 0 }; slot < max<size_t>(threadCount, 1); ++slot) {
+		auto core = cores.empty() ? optional<size_t>{ } : cores[slot % cores.size()];
+		m_Workers.emplace_back([this, slot, core] {
+			PinCurrentThread(core);
+			WorkerLoop(slot);
+		});
+	}
+}
+
+THREAD_POOL::~THREAD_POOL() {
+	{
+		auto lock = std::lock_guard{ m_Mutex };
+		m_Stopping = true;
+	}
+	m_WorkReady.notify_all();
+	for (auto& worker : m_Workers) { worker.join(); }
+}
+
+size_t THREAD_POOL::DefaultThreadCount() noexcept {
+	return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+}
+
+size_t THREAD_POOL::NodeCount() noexcept {
+	return Topology().nodeCount;
+}
+
+size_t THREAD_POOL::CurrentNode() noexcept {
+#ifdef __linux__
+	auto cpu = sched_getcpu();
+	const auto& nodes = Topology().cpuNodes;
+	if (cpu >= 0 && static_cast<size_t>(cpu) < nodes.size()) { return nodes[cpu]; }
+#endif // __linux__
+	return 0;
+}
+
+// Workers take one index at a time from the oldest batch they can help with
+void THREAD_POOL::WorkerLoop(size_t slot) noexcept {
+	auto lock = std::unique_lock{ m_Mutex };
+	while (true) {
+		auto* batch = static_cast<BATCH*>(nullptr);
+		m_WorkReady.wait(lock, [this, slot, &batch] {
+			batch = FindWork(slot);
+			return m_Stopping || batch;
+		});
+		if (m_Stopping) { return; }
+
+		if (!batch->claimed.empty()) {
+			RunOwned(*batch, slot, lock);
+			continue;
+		}
+		auto index = batch->next++;
+		if (batch->next == batch->count) { m_Batches.remove(batch); }
+		lock.unlock();
+		(*batch->task)(index);
+		lock.lock();
+		Finish(*batch);
+	}
+}
+
+// Shared batches take any worker; an owned batch only the slots whose runs are still unclaimed
+THREAD_POOL::BATCH* THREAD_POOL::FindWork(size_t slot) const noexcept {
+	for (auto* batch : m_Batches) {
+		if (batch->claimed.empty() || !batch->claimed[slot]) { return batch; }
+	}
+	return nullptr;
+}
+
+// Called & returns with the lock held
+void THREAD_POOL::RunOwned(BATCH& batch, size_t slot, std::unique_lock<std::mutex>& lock) noexcept {
+	auto slots = batch.claimed.size();
+	batch.claimed[slot] = true;
+	if (++batch.claimedCount == slots) { m_Batches.remove(&batch); }
+
+	auto first = batch.count * slot / slots;
+	auto end = batch.count * (slot + 1) / slots;
+	if (first == end) { return; }
+	lock.unlock();
+	for (auto index = first; index < end; ++index) { (*batch.task)(index); }
+	lock.lock();
+	batch.finished += end - first;
+	if (batch.finished == batch.count) { m_WorkDone.notify_all(); }
+}
+
+void THREAD_POOL::Finish(BATCH& batch) noexcept {
+	if (++batch.finished == batch.count) { m_WorkDone.notify_all(); }
+}
+
+void THREAD_POOL::ForEach(size_t count, const std::function<void(size_t)>& task) noexcept {
+	if (count == 0) { return; }
+	if (m_Workers.empty() || count == 1) {
+		for (auto i = size_t{ 0 }; i < count; ++i) { task(i); }
+		return;
+	}
+
+	auto batch = BATCH{ &task, count };
+	auto lock = std::unique_lock{ m_Mutex };
+	m_Batches.push_back(&batch);
+	m_WorkReady.notify_all();
+
+	// Help out with this batch until every index is handed out, then wait for the stragglers
+	while (batch.next < batch.count) {
+		auto index = batch.next++;
+		if (batch.next == batch.count) { m_Batches.remove(&batch); }
+		lock.unlock();
+		task(index);
+		lock.lock();
+		Finish(batch);
+	}
+	m_WorkDone.wait(lock, [&batch] { return batch.finished == batch.count; });
+}
+
+void THREAD_POOL::ForEachOwned(size_t count, const std::function<void(size_t)>& task) noexcept {
+	if (count == 0) { return; }
+	if (m_Workers.empty()) {
+		for (auto i = size_t{ 0 }; i < count; ++i) { task(i); }
+		return;
+	}
+
+	auto batch = BATCH{ &task, count };
+	batch.claimed.assign(ThreadCount(), false);
+	auto lock = std::unique_lock{ m_Mutex };
+	m_Batches.push_back(&batch);
+	m_WorkReady.notify_all();
+
+	// Unpinned, the caller is slot 0; slots whose runs are empty may never come for the batch, so it is withdrawn here
+	if (!m_Pinned) { RunOwned(batch, 0, lock); }
+	m_WorkDone.wait(lock, [&batch] { return batch.finished == batch.count; });
+	if (batch.claimedCount < batch.claimed.size()) { m_Batches.remove(&batch); }
+}
@@ -0,0 +1,60 @@
+#ifndef THREAD_POOL_CLASS_H
+#define THREAD_POOL_CLASS_H
+#include "framework.h"
+
+// THREAD_POOL runs data-parallel loops on a fixed set of threads
+// A LIFE_HISTORY creates its own pool unless handed one, so many simulations can also share a single pool
+// Any number of threads may call ForEach at once; their batches are interleaved across the pool
+// The calling thread always works on its own batch, so a pool of one thread has no workers & runs everything inline
+//
+// A pinned pool instead starts a worker per thread & ties each to one core, filling the cores of one NUMA node before the next (Linux only)
+// With ForEachOwned, the rows a worker writes first are then placed in its own node's memory & stay with it from call to call
+class THREAD_POOL {
+	struct BATCH {
+		const std::function<void(size_t)>* task{ nullptr };
+		size_t count{ 0 };
+		size_t next{ 0 };			// Next index to hand out
+		size_t finished{ 0 };
+		std::vector<bool> claimed{ };	// Owned batches only, per slot whether its run has been taken
+		size_t claimedCount{ 0 };
+	};
+
+	std::vector<std::thread> m_Workers{ };
+	bool m_Pinned{ false };
+	std::mutex m_Mutex{ };
+	std::condition_variable m_WorkReady{ };
+	std::condition_variable m_WorkDone{ };
+	std::list<BATCH*> m_Batches{ };		// Batches with indices still to hand out, oldest first
+	bool m_Stopping{ false };
+
+	void WorkerLoop(size_t slot) noexcept;
+	[[nodiscard]] BATCH* FindWork(size_t slot) const noexcept;
+	void RunOwned(BATCH& batch, size_t slot, std::unique_lock<std::mutex>& lock) noexcept;
+	void Finish(BATCH& batch) noexcept;
+
+public:
+	explicit THREAD_POOL(size_t threadCount = DefaultThreadCount(), bool pinned = false);
+	THREAD_POOL(const THREAD_POOL&) = delete;
+	THREAD_POOL& operator=(const THREAD_POOL&) = delete;
+	~THREAD_POOL();
+
+	[[nodiscard]] static size_t DefaultThreadCount() noexcept;
+	[[nodiscard]] size_t ThreadCount() const noexcept { return m_Pinned ? m_Workers.size() : m_Workers.size() + 1; }
+	[[nodiscard]] bool Pinned() const noexcept { return m_Pinned; }
+
+	// Call task(i) for every i in [0, count), returning once all calls are complete
+	// The task must not throw
+	void ForEach(size_t count, const std::function<void(size_t)>& task) noexcept;
+
+	// As ForEach, but [0, count) is split into one contiguous run per thread & a given count always splits the same way
+	// Each run goes to the same thread every call; in a pinned pool the calling thread only waits, as it is not tied to a core
+	// Unlike ForEach it must not be called from a task running on the same pool, as that task's thread may own a run
+	void ForEachOwned(size_t count, const std::function<void(size_t)>& task) noexcept;
+
+	// NUMA nodes of this machine, from /sys/devices/system/node; elsewhere a single node
+	[[nodiscard]] static size_t NodeCount() noexcept;
+	// Node of the core the calling thread is running on at the moment
+	[[nodiscard]] static size_t CurrentNode() noexcept;
+};
+
+#endif // !THREAD_POOL_CLASS_H
@@ -2,6 +2,10 @@
 #define RYANS_UTILITIES_H
 
 #include "framework.h"
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif // !_WIN32
 
 namespace RYANS_UTILITIES {
 
@@ -68,6 +72,77 @@ namespace RYANS_UTILITIES {
 		return true;
 	}
 
+	// Write a trivially copyable value to a binary stream as raw bytes (native byte order)
+	template<class T>
+	void WriteBinary(std::ostream& stream, const T& value) {
+		static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be written as raw bytes.");
+		stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	// Read a trivially copyable value written by WriteBinary
+	// Check the stream state afterward, the value is zero-initialized on failure
+	template<class T>
+	T ReadBinary(std::istream& stream) {
+		static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be read as raw bytes.");
+		auto value = T{ };
+		stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+		return value;
+	}
+
+	// Flush a closed file's contents from the system's cache through to the storage device
+	// Returns false if the file cannot be opened or the system reports a failure
+	inline bool SyncFile(const std::filesystem::path& path) noexcept {
+#ifdef _WIN32
+		auto file = CreateFileW(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE) { return false; }
+		auto synced = FlushFileBuffers(file) != 0;
+		CloseHandle(file);
+#else
+		auto descriptor = ::open(path.c_str(), O_WRONLY);
+		if (descriptor < 0) { return false; }
+		auto synced = ::fsync(descriptor) == 0;
+		::close(descriptor);
+#endif // _WIN32
+		return synced;
+	}
+
+	// Flush a directory's entries, so a file just renamed into it survives a crash (POSIX)
+	// Best effort: some file systems cannot sync a directory, & Windows renames through to the disk itself (see WriteFileAtomically)
+	inline void SyncDirectory([[maybe_unused]] const std::filesystem::path& directory) noexcept {
+#ifndef _WIN32
+		auto descriptor = ::open(directory.empty() ? "." : directory.c_str(), O_RDONLY | O_DIRECTORY);
+		if (descriptor < 0) { return; }
+		::fsync(descriptor);
+		::close(descriptor);
+#endif // !_WIN32
+	}
+
+	// Write a file so that it is either fully replaced or left untouched, even across a crash or power loss
+	// The content goes to a temporary sibling file, synced to the disk, then renamed over the target; the rename is synced too
+	// Variable "writer" receives an std::ostream& and may throw to abandon the write
+	template<class Writer>
+	void WriteFileAtomically(const std::filesystem::path& path, Writer&& writer) {
+		auto temporaryPath = path;
+		temporaryPath += ".tmp";
+		{
+			auto file = std::ofstream{ temporaryPath, std::ios::binary | std::ios::trunc };
+			if (!file) { throw std::runtime_error{ "Unable to open " + temporaryPath.string() + " for writing." }; }
+			try { writer(static_cast<std::ostream&>(file)); file.flush(); }
+			catch (...) { file.close(); std::filesystem::remove(temporaryPath); throw; }
+			if (!file) { file.close(); std::filesystem::remove(temporaryPath); throw std::runtime_error{ "Failed writing " + temporaryPath.string() + "." }; }
+		}
+		if (!SyncFile(temporaryPath)) { std::filesystem::remove(temporaryPath); throw std::runtime_error{ "Failed syncing " + temporaryPath.string() + " to disk." }; }
+#ifdef _WIN32
+		if (!MoveFileExW(temporaryPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+			std::filesystem::remove(temporaryPath);
+			throw std::runtime_error{ "Unable to replace " + path.string() + "." };
+		}
+#else
+		std::filesystem::rename(temporaryPath, path);
+		SyncDirectory(path.parent_path());
+#endif // _WIN32
+	}
+
 	// Test if a scoped (class) enum has the specified flag
 	// The "state" is expected to be an enum that uses bit-masking to combine multiple flags
 	// Variable "hasFlag" is the flag of interest, which my be a component or composite flag
@@ -2,33 +2,40 @@
 
 // Window proceedure for the top-level frame window
 // Dispatches window messages to appropriate functions
+// The game session lives from WM_CREATE through WM_DESTROY, any other message outside that span gets default handling
 LRESULT CALLBACK WndProc(HWND hFrame, UINT message, WPARAM wParam, LPARAM lParam) {
+    if (message == WM_CREATE) { InitializeGame(hFrame); return 0; }
+    auto* game = GetGameSession(hFrame);
+    if (game == nullptr) { return DefWindowProc(hFrame, message, wParam, lParam); }
+    auto& session = *game;
+
     switch (message) {
-        case WM_CREATE: { InitializeGame(hFrame); } break;
         case WM_KEYDOWN: {
             switch (wParam) {
-                case VK_RETURN: { TogglePause(); ResetTimer(hFrame); } break;
-                case VK_RIGHT: { StepGeneration(1); } break;
-                case VK_LEFT: { StepGeneration(-1); } break;
+                case VK_RETURN: { TogglePause(session); ResetTimer(hFrame); } break;
+                case VK_RIGHT: { StepGeneration(session, 1); } break;
+                case VK_LEFT: { StepGeneration(session, -1); } break;
+                case 'S': { if (GetKeyState(VK_CONTROL) < 0) { SaveSession(session); } } break;
+                case 'O': { if (GetKeyState(VK_CONTROL) < 0) { LoadSession(session); } } break;
             }
         } break;
         case WM_COMMAND: {
             // Parse the menu selections:
             int wmId = LOWORD(wParam);
             switch (wmId) {
-                case WM_ADVANCE_GENERATION: { StepGeneration(1); ResetTimer(hFrame); } break;
-                case IDC_TOGGLE_EXTENDED: { ToggleExtendedBrushes(hFrame); } break;
+                case WM_ADVANCE_GENERATION: { StepGeneration(session, 1); ResetTimer(hFrame); } break;
+                case IDC_TOGGLE_EXTENDED: { ToggleExtendedBrushes(session, hFrame); } break;
                 case IDM_ABOUT: { DialogBox(g_hInst, MAKEINTRESOURCE(IDD_ABOUTBOX), hFrame, About); } break;
                 case IDM_EXIT: { DestroyWindow(hFrame); } break;
                 default: { return DefWindowProc(hFrame, message, wParam, lParam); }
             }
         } break;
         case WM_PAINT: { static_cast<void>(WINDOW{ hFrame }.BeginPaint()); } break;     // Re-validates window
-        case WM_DESTROY: { CleanupGameResources(hFrame); PostQuitMessage(0); } break;
+        case WM_DESTROY: { CleanupGameResources(hFrame); PostQuitMessage(0); return 0; } break;
         default: { return DefWindowProc(hFrame, message, wParam, lParam); }             // Pass along any unhandled messages
     }
 
-    CheckTimer(hFrame);     // Explicitly check for WM_TIMER messages since they are given very low priority and are often suppressed 
+    CheckTimer(session, hFrame);     // Explicitly check for WM_TIMER messages since they are given very low priority and are often suppressed 
     return 0;               // Terminate any message that is explicitly handled
 }
 
@@ -37,9 +44,11 @@ LRESULT CALLBACK WndProc(HWND hFrame, UINT message, WPARAM wParam, LPARAM lParam
 // Features include using arrow keys to move between cells and responding to user focus.
 // Without this, cells would only display text on character input.
 LRESULT CALLBACK CellWindowProc(HWND hCell, UINT message, WPARAM wParam, LPARAM lParam) {
+    auto* session = GetGameSession(GetParent(hCell));
+    if (session == nullptr) { return DefWindowProc(hCell, message, wParam, lParam); }
     switch (message) {
-        case WM_LBUTTONDOWN: { ToggleCellState(hCell); return 0; } break;
-        case WM_PAINT: { RedrawCell(hCell); } break;
+        case WM_LBUTTONDOWN: { ToggleCellState(*session, hCell); return 0; } break;
+        case WM_PAINT: { RedrawCell(*session, hCell); } break;
         default: { DefWindowProc(hCell, message, wParam, lParam); }
     }
 
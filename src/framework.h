@@ -4,22 +4,50 @@
 
 #pragma once
 
+// The simulation engine & headless tool also build on other platforms, only the GUI needs Windows
+#ifdef _WIN32
 #include "targetver.h"
 #include "Resource.h"
 #define WIN32_LEAN_AND_MEAN             // Exclude rarely-used stuff from Windows headers
 // Windows Header Files
 #include <windows.h>
+#include <malloc.h>
+#include <tchar.h>
+#endif // _WIN32
 // C RunTime Header Files
 #include <stdlib.h>
 #include <algorithm>
-#include <execution>
-#include <malloc.h>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <istream>
+#include <iterator>
+#include <list>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
 #include <string>
-#include <tchar.h>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
+#ifdef _WIN32
 // Global Variables:
 extern HINSTANCE g_hInst;                              // current instance
-extern HWND g_hWnd;                                    // Handle of top-level window
\ No newline at end of file
+extern HWND g_hWnd;                                    // Handle of top-level window
+#endif // _WIN32
\ No newline at end of file